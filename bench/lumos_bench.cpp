@@ -0,0 +1,387 @@
+// Lumos - Ramp and histogram microbenchmarks
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+// Times the pure math behind every gamma change: ramp building, custom
+// curve evaluation, the adaptive scale search (against a simulated driver)
+// and the luminance histogram kernels. No display or GPU is touched, so the
+// numbers are comparable across machines and builds.
+//
+//   lumos_bench [filter]   Run benchmarks whose name contains filter
+//
+// A few untimed checks of the search behaviour always run last; the exit
+// code is non-zero if any of them fails.
+
+#include "platform/win32/luminance_kernel.h"
+#include "platform/win32/ramp_math.h"
+#include "platform/win32/tone_curve.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace lumos::platform;
+
+namespace {
+
+// Keeps results observable so the optimizer can't drop the work
+volatile uint64_t g_sink = 0;
+
+void consume(const GammaRamp& ramp)
+{
+    g_sink = g_sink + ramp.red[128] + ramp.green[64] + ramp.blue[192];
+}
+
+void consume(double value)
+{
+    g_sink = g_sink + static_cast<uint64_t>(value * 65535.0);
+}
+
+const char* g_filter = nullptr;
+
+// Run fn in batches of iterations calls and report the per-call time of
+// the fastest and the median batch. Batches are sized to ~10 ms each.
+// False if the filter skipped it.
+template <typename Fn>
+bool bench(const std::string& name, Fn&& fn)
+{
+    if (g_filter && name.find(g_filter) == std::string::npos) return false;
+
+    using Clock = std::chrono::steady_clock;
+    auto run_batch = [&](int iterations) {
+        auto start = Clock::now();
+        for (int i = 0; i < iterations; ++i) fn();
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    // Calibrate the batch size
+    int iterations = 1;
+    while (iterations < (1 << 24)) {
+        if (run_batch(iterations) >= 10e6) break;
+        iterations *= 2;
+    }
+
+    constexpr int kBatches = 9;
+    std::vector<double> per_call;
+    for (int b = 0; b < kBatches; ++b) {
+        per_call.push_back(run_batch(iterations) / iterations);
+    }
+    std::sort(per_call.begin(), per_call.end());
+
+    std::printf("  %-52s %12.1f ns  %12.1f ns  %10d\n", name.c_str(), per_call[kBatches / 2],
+                per_call.front(), iterations);
+    return true;
+}
+
+// Driver stand-in for the adaptive search: accepts a ramp only if no entry
+// strays more than max_deviation from identity, the way real drivers
+// refuse "extreme" ramps. Rejections are either hard failures or silent
+// (the readback keeps the previous ramp), like the two cases seen on
+// Windows.
+struct SimulatedDriver {
+    int max_deviation = 65535;
+    bool silent = true;
+    bool offline = false;  // Every set and readback fails (mode switch, lock)
+    GammaRamp current = buildIdentityRamp();
+
+    bool acceptable(const GammaRamp& ramp) const
+    {
+        static const GammaRamp identity = buildIdentityRamp();
+        for (size_t i = 0; i < 256; ++i) {
+            if (std::abs(ramp.red[i] - identity.red[i]) > max_deviation ||
+                std::abs(ramp.green[i] - identity.green[i]) > max_deviation ||
+                std::abs(ramp.blue[i] - identity.blue[i]) > max_deviation) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool set(const GammaRamp& ramp)
+    {
+        if (offline) return false;
+        if (!acceptable(ramp)) return silent;
+        current = ramp;
+        return true;
+    }
+
+    RampReadback verify(const GammaRamp& expected) const
+    {
+        if (offline) return RampReadback::Failed;
+        return rampsMatch(expected, current) ? RampReadback::Matched : RampReadback::Mismatched;
+    }
+};
+
+// A custom curve with count points on a gentle S-shape
+std::vector<CurvePoint> makeCurve(size_t count)
+{
+    std::vector<CurvePoint> points;
+    for (size_t i = 0; i < count; ++i) {
+        double x = static_cast<double>(i) / static_cast<double>(count - 1);
+        double y = x + 0.08 * std::sin(6.283185307179586 * x);
+        points.push_back({x, std::clamp(y, 0.0, 1.0)});
+    }
+    return points;
+}
+
+void runRampBenchmarks()
+{
+    std::printf("\nRamp building\n");
+    const struct {
+        const char* name;
+        ToneCurve curve;
+        double strength;
+    } presets[] = {
+        {"linear", ToneCurve::Linear, 1.0},
+        {"power 2.2", ToneCurve::Power, 2.2},
+        {"shadowlift", ToneCurve::ShadowLift, 1.0},
+        {"cinema", ToneCurve::Cinema, 1.0},
+    };
+    for (const auto& preset : presets) {
+        bench(std::string("buildRamp ") + preset.name,
+              [&] { consume(buildRamp(preset.curve, preset.strength)); });
+    }
+    bench("buildRamp power 2.2 @ 3400 K",
+          [] { consume(buildRamp(ToneCurve::Power, 2.2, nullptr, CurveInterpolation::Linear, 3400.0)); });
+
+    const GammaRamp identity = buildIdentityRamp();
+    const GammaRamp cinema = buildRamp(ToneCurve::Cinema, 1.0);
+    bench("blendRampTowardIdentity", [&] { consume(blendRampTowardIdentity(cinema, identity, 0.6)); });
+    bench("enforceMonotonicity", [&] {
+        GammaRamp ramp = cinema;
+        enforceMonotonicity(ramp);
+        consume(ramp);
+    });
+    bench("rampsMatch", [&] { g_sink = g_sink + rampsMatch(cinema, cinema); });
+    bench("rampsMatchSampled", [&] { g_sink = g_sink + rampsMatchSampled(cinema, cinema); });
+
+    std::vector<GammaRamp> frames;
+    bench("buildTransitionFrames x15", [&] {
+        buildTransitionFrames(identity, cinema, 15, frames);
+        consume(frames.back());
+    });
+}
+
+void runCurveBenchmarks()
+{
+    std::printf("\nCustom curves\n");
+    for (size_t count : {8u, 64u, 512u, 4096u}) {
+        const std::vector<CurvePoint> points = makeCurve(count);
+        for (CurveInterpolation interpolation :
+             {CurveInterpolation::Linear, CurveInterpolation::MonotoneCubic}) {
+            const char* mode = (interpolation == CurveInterpolation::Linear) ? "linear" : "cubic";
+            std::string suffix = " " + std::to_string(count) + " pts " + mode;
+
+            bench("buildRamp custom" + suffix, [&] {
+                consume(buildRamp(ToneCurve::Custom, 1.0, &points, interpolation));
+            });
+
+            const CompiledCurve compiled(points, interpolation);
+            bench("CompiledCurve::sample" + suffix, [&] {
+                CurveTable table;
+                compiled.sample(table);
+                consume(table[100]);
+            });
+            bench("CompiledCurve::evaluate" + suffix, [&] {
+                consume(compiled.evaluate(0.377));
+            });
+        }
+    }
+}
+
+void printSearchResult(const RampSearchResult& result)
+{
+    std::printf("  %-52s scale %.3f, %d set call%s%s\n", "", result.scale, result.attempts,
+                result.attempts == 1 ? "" : "s", result.success ? "" : ", failed");
+}
+
+void runSearchBenchmarks()
+{
+    std::printf("\nAdaptive search (simulated driver)\n");
+    const GammaRamp ideal = buildRamp(ToneCurve::Power, 2.8);
+
+    const struct {
+        const char* name;
+        int max_deviation;
+        bool silent;
+        double start_scale;
+    } cases[] = {
+        {"accept all, known scale", 65535, true, 1.0},
+        {"limit 8000, probe from 1.0 (silent)", 8000, true, 1.0},
+        {"limit 8000, probe from 1.0 (hard)", 8000, false, 1.0},
+        {"limit 2000, probe from 1.0 (silent)", 2000, true, 1.0},
+        {"reject all", 0, true, 1.0},
+    };
+    for (const auto& c : cases) {
+        SimulatedDriver driver;
+        driver.max_deviation = c.max_deviation;
+        driver.silent = c.silent;
+
+        RampSearchResult sample{};
+        auto search = [&] {
+            driver.current = buildIdentityRamp();
+            sample = searchRampScale(
+                ideal, c.start_scale,
+                [&](const GammaRamp& ramp) { return driver.set(ramp); },
+                [&](const GammaRamp& ramp) { return driver.verify(ramp); });
+            consume(sample.accepted);
+        };
+        if (!bench(std::string("searchRampScale ") + c.name, search)) continue;
+        printSearchResult(sample);
+    }
+
+    // Envelope fit: cold learns from scratch every call; warm keeps the
+    // envelope, as a monitor does across applies, and cycles through
+    // strengths so it isn't just replaying one ramp
+    const GammaRamp strengths[] = {
+        buildRamp(ToneCurve::Power, 1.6), buildRamp(ToneCurve::Power, 2.2),
+        buildRamp(ToneCurve::Power, 2.8), buildRamp(ToneCurve::Cinema, 1.0),
+    };
+    for (int limit : {65535, 8000, 2000}) {
+        for (bool warm : {false, true}) {
+            SimulatedDriver driver;
+            driver.max_deviation = limit;
+
+            RampEnvelope envelope;
+            size_t next = 0;
+            int total_sets = 0;
+            int calls = 0;
+            RampSearchResult sample{};
+            auto fit = [&] {
+                if (!warm) envelope = RampEnvelope();
+                driver.current = buildIdentityRamp();
+                const GammaRamp& target = warm ? strengths[next++ % std::size(strengths)] : ideal;
+                sample = fitRampToEnvelope(
+                    target, envelope, nullptr,
+                    [&](const GammaRamp& ramp) { return driver.set(ramp); },
+                    [&](const GammaRamp& ramp) { return driver.verify(ramp); });
+                total_sets += sample.attempts;
+                ++calls;
+                consume(sample.accepted);
+            };
+            std::string name = "fitRampToEnvelope limit " + std::to_string(limit) +
+                               (warm ? " (warm)" : " (cold)");
+            if (!bench(name, fit)) continue;
+            if (warm) {
+                std::printf("  %-52s %.2f set calls per apply\n", "",
+                            static_cast<double>(total_sets) / calls);
+            } else {
+                printSearchResult(sample);
+            }
+        }
+    }
+}
+
+void runHistogramBenchmarks(const char* label, int width, int height)
+{
+    std::printf("\nLuminance histogram (%dx%d BGRA, %s)\n", width, height, label);
+    const int pitch = width * 4 + 64;  // Padded rows, like a mapped texture
+
+    // Mostly flat UI-like content with a noisy band, the two cases the
+    // sub-histograms exist for
+    std::vector<uint8_t> pixels(static_cast<size_t>(pitch) * height);
+    uint32_t seed = 12345;
+    for (int y = 0; y < height; ++y) {
+        uint8_t* row = pixels.data() + static_cast<size_t>(y) * pitch;
+        for (int x = 0; x < width * 4; ++x) {
+            seed = seed * 1664525u + 1013904223u;
+            row[x] = (y < height / 3) ? static_cast<uint8_t>(seed >> 24) : 0xF0;
+        }
+    }
+
+    LuminanceKernel best = detectLuminanceKernel();
+    const struct {
+        LuminanceKernel kernel;
+        void (*fn)(const uint8_t*, int, int, int, LuminanceHistogram&);
+    } kernels[] = {
+        {LuminanceKernel::Scalar, accumulateLuminanceScalar},
+        {LuminanceKernel::Sse41, accumulateLuminanceSse41},
+        {LuminanceKernel::Avx2, accumulateLuminanceAvx2},
+    };
+    for (const auto& k : kernels) {
+        if (static_cast<int>(k.kernel) > static_cast<int>(best)) {
+            std::printf("  %-52s (not supported on this CPU)\n", luminanceKernelName(k.kernel));
+            continue;
+        }
+        bench(std::string("accumulateLuminance ") + luminanceKernelName(k.kernel), [&] {
+            LuminanceHistogram histogram{};
+            k.fn(pixels.data(), width, height, pitch, histogram);
+            g_sink = g_sink + histogram[128];
+        });
+    }
+}
+
+void runHistogramBenchmarks()
+{
+    // The CPU kernels only see full-resolution frames when neither the GPU
+    // histogram nor the mip readback is available; the sub-millisecond
+    // budget applies to the 1/16-pixel mip/GDI input, not to full 4K
+    runHistogramBenchmarks("full 1080p", 1920, 1080);
+    runHistogramBenchmarks("full 4K", 3840, 2160);
+    runHistogramBenchmarks("4K mip/GDI input", 3840 / 4, 2160 / 4);
+}
+
+// Behaviour the benchmarks rely on but don't time. False if any failed.
+bool runSearchChecks()
+{
+    std::printf("\nAdaptive search checks\n");
+    bool all_passed = true;
+    auto check = [&](const char* name, bool passed) {
+        std::printf("  %-52s %s\n", name, passed ? "ok" : "FAILED");
+        all_passed = all_passed && passed;
+    };
+
+    const GammaRamp ideal = buildRamp(ToneCurve::Power, 2.8);
+    SimulatedDriver driver;
+    driver.max_deviation = 8000;
+    auto set = [&](const GammaRamp& ramp) { return driver.set(ramp); };
+    auto verify = [&](const GammaRamp& ramp) { return driver.verify(ramp); };
+
+    RampEnvelope envelope;
+    RampSearchResult learned = fitRampToEnvelope(ideal, envelope, nullptr, set, verify);
+
+    // An outage must not read as rejections: the envelope stays as it was
+    // and, once the device is back, the fit is no weaker than before
+    const RampEnvelope before = envelope;
+    driver.offline = true;
+    bool untouched = true;
+    for (int i = 0; i < 8; ++i) {
+        RampSearchResult failed = fitRampToEnvelope(ideal, envelope, nullptr, set, verify);
+        untouched = untouched && !failed.success && failed.hard_failure &&
+                    envelope.safe == before.safe && envelope.limit == before.limit;
+    }
+    check("fitRampToEnvelope leaves envelope on hard failure", untouched);
+
+    driver.offline = false;
+    RampSearchResult recovered = fitRampToEnvelope(ideal, envelope, nullptr, set, verify);
+    check("fitRampToEnvelope recovers after hard failure",
+          learned.success && recovered.success && recovered.scale >= learned.scale);
+
+    return all_passed;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1) {
+        if (std::strcmp(argv[1], "--help") == 0 || std::strcmp(argv[1], "-h") == 0) {
+            std::printf("Usage: lumos_bench [filter]\n");
+            return 0;
+        }
+        g_filter = argv[1];
+    }
+
+    std::printf("Lumos bench (per call: median, fastest, calls per batch)\n");
+    runRampBenchmarks();
+    runCurveBenchmarks();
+    runSearchBenchmarks();
+    runHistogramBenchmarks();
+    bool checks_passed = runSearchChecks();
+    std::printf("\n");
+    return checks_passed ? 0 : 1;
+}
@@ -3,8 +3,13 @@
 // License: GPL v2
 
 #include "app.h"
+#include "cli.h"
+#include "platform/win32/curve_library.h"
+#include <wtsapi32.h>
 #include <cstdio>
+#include <cwchar>
 #include <algorithm>
+#include <utility>
 
 namespace lumos {
 
@@ -37,42 +42,82 @@ std::string toneCurveToString(platform::ToneCurve curve) {
 }
 } // anonymous namespace
 
-bool App::initialize(HWND hwnd, UINT tray_msg)
+bool App::initialize(HWND hwnd, UINT tray_msg, AppMode mode)
 {
     hwnd_ = hwnd;
+    mode_ = mode;
+    window_visible_ = (mode == AppMode::Window);
 
-    // Load config
+    // Load config, and start saving changes in the background from here on
     config_.load();
+    for (size_t i = 0; i < kConfigSectionCount; ++i) {
+        config_sections_[i] = config_.serializeSection(static_cast<ConfigSection>(i));
+    }
+    config_writer_.start(config_.getConfigPath(), Config::joinSections(config_sections_),
+                         getCurveLibraryPath());
     current_gamma_ = config_.last_gamma;
     tone_curve_ = stringToToneCurve(config_.transfer_function);
+    white_point_k_ = config_.white_point_k;
     custom_curve_points_ = config_.custom_curve_points;
+    custom_interpolation_ = config_.custom_curve_smooth
+        ? platform::CurveInterpolation::MonotoneCubic : platform::CurveInterpolation::Linear;
 
     // Ensure custom curve has valid default if empty
     if (custom_curve_points_.empty()) {
         custom_curve_points_ = {{0.0, 0.0}, {1.0, 1.0}};  // Linear default
     }
 
+    for (const auto& entry : config_.profiles) {
+        DisplayProfile profile;
+        profile.monitor_id = utf8ToWide(entry.monitor_id);
+        profile.curve = stringToToneCurve(entry.curve);
+        profile.strength = entry.strength;
+        profile.custom_curve_points = entry.custom_curve_points;
+        profile.custom_interpolation = entry.custom_curve_smooth
+            ? platform::CurveInterpolation::MonotoneCubic : platform::CurveInterpolation::Linear;
+        profiles_.push_back(std::move(profile));
+    }
+
     // Initialize gamma (captures original ramps for all monitors)
     if (!gamma_.initialize()) {
         std::snprintf(status_text_, sizeof(status_text_), "Warning: Could not initialize gamma");
     }
 
+    // Seed adaptive scales learned in earlier sessions, so the saved curve
+    // applies without re-probing the driver
+    std::vector<platform::SafeScaleRecord> scale_records;
+    for (const auto& entry : config_.safe_scales) {
+        scale_records.push_back({utf8ToWide(entry.monitor_id),
+                                 stringToToneCurve(entry.curve), entry.scale});
+    }
+    gamma_.seedSafeScales(scale_records);
+    loadCurveLibrary();
+
+    // All ramp changes after this point run on the apply worker, which
+    // also owns the monitor list; take the UI thread's copy of it
+    gamma_worker_.start(gamma_);
+    pollTopology();
+    gamma_worker_.pollAcceptedRamps(accepted_ramps_);  // As loaded from the library
+
     // Apply saved tone curve to all monitors
-    if (current_gamma_ != 1.0 || tone_curve_ != platform::ToneCurve::Power) {
-        if (tone_curve_ == platform::ToneCurve::Custom) {
-            gamma_.applyAll(tone_curve_, current_gamma_, &custom_curve_points_);
-        } else {
-            gamma_.applyAll(tone_curve_, current_gamma_);
-        }
+    if (current_gamma_ != 1.0 || tone_curve_ != platform::ToneCurve::Power ||
+        white_point_k_ != platform::kNeutralWhitePointK || !profiles_.empty()) {
+        postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, false);
     }
 
+    // A scheduled entry due now overrides the saved curve
+    // Manual-reset, so the main loop's wait doesn't consume the signal
+    // before update() sees it
+    schedule_timer_ = CreateWaitableTimerW(nullptr, TRUE, nullptr);
+    syncSchedule();
+
     // Apply always-on-top setting if enabled
-    if (config_.always_on_top) {
+    if (config_.always_on_top && mode_ == AppMode::Window) {
         SetWindowPos(hwnd_, HWND_TOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
     }
 
-    // Create tray icon
-    if (!tray_.create(hwnd_, tray_msg)) {
+    // Create tray icon (the agent has nothing to open from it)
+    if (mode_ == AppMode::Window && !tray_.create(hwnd_, tray_msg)) {
         std::snprintf(status_text_, sizeof(status_text_), "Warning: Could not create tray icon");
     }
 
@@ -99,10 +144,11 @@ bool App::initialize(HWND hwnd, UINT tray_msg)
     hotkeys_.on_reset = [this]() { resetGamma(); };
     hotkeys_.on_toggle = [this]() { toggleGamma(); };
 
-    // Start screen histogram capture
-    histogram_.start();
+    // Start screen histogram capture, one sampler per gamma-controlled monitor
+    histogram_.setMonitors(topology_.handles);
+    updateHistogramCapture();
 
-    size_t count = gamma_.getMonitorCount();
+    size_t count = getMonitorCount();
     std::snprintf(status_text_, sizeof(status_text_), "Applied to %zu display%s",
                   count, count == 1 ? "" : "s");
     return true;
@@ -116,12 +162,38 @@ void App::shutdown()
     // Shutdown hotkeys
     hotkeys_.shutdown();
 
-    // Save config (hotkey bindings are already in config_ after any setHotkeys calls)
-    config_.last_gamma = current_gamma_;
-    config_.transfer_function = toneCurveToString(tone_curve_);
-    config_.custom_curve_points = custom_curve_points_;
-    // Hotkey bindings are updated by setHotkeys() and stored in config_
-    config_.save();
+    // Let the apply worker finish its current ramp before restoring
+    gamma_worker_.stop();
+
+    if (schedule_timer_) {
+        CancelWaitableTimer(schedule_timer_);
+        CloseHandle(schedule_timer_);
+        schedule_timer_ = nullptr;
+        schedule_armed_ = false;
+    }
+
+    // Merge learned scales, keeping entries for monitors not connected now
+    for (const auto& record : gamma_.getSafeScales()) {
+        std::string monitor_id = wideToUtf8(record.monitor_id);
+        std::string curve = toneCurveToString(record.curve);
+        auto it = std::find_if(config_.safe_scales.begin(), config_.safe_scales.end(),
+            [&](const SafeScaleEntry& e) { return e.monitor_id == monitor_id && e.curve == curve; });
+        if (it != config_.safe_scales.end()) {
+            it->scale = record.scale;
+        } else {
+            config_.safe_scales.push_back({monitor_id, curve, record.scale});
+        }
+    }
+
+    // Settings changes were saved as they happened; only the scales (owned
+    // by the worker until now) and anything from the last second are left.
+    // The curve library was likewise written as curves and ramps changed.
+    if (gamma_worker_.pollAcceptedRamps(accepted_ramps_)) {
+        curve_library_dirty_ = true;
+    }
+    markConfigDirty(ConfigSection::SafeScale);
+    persistConfig();
+    config_writer_.stop();
 
     // Restore original gamma on all monitors
     gamma_.restoreAll();
@@ -130,72 +202,408 @@ void App::shutdown()
     tray_.destroy();
 }
 
-void App::setGamma(double value)
+void App::update()
 {
-    value = std::clamp(value, 0.1, 9.0);
-    current_gamma_ = value;
+    if (gamma_worker_.pollAcceptedRamps(accepted_ramps_)) {
+        curve_library_dirty_ = true;
+    }
+    if (dirty_sections_ || curve_library_dirty_) {
+        persistConfig();
+    }
+
+    if (schedule_armed_ && WaitForSingleObject(schedule_timer_, 0) == WAIT_OBJECT_0) {
+        schedule_armed_ = false;
+        const auto& entries = config_.schedule.entries;
+        if (next_schedule_event_.entry < entries.size()) {
+            const ScheduleEntry& entry = entries[next_schedule_event_.entry];
+            applyScheduleEntry(entry, entry.fade_ms);
+        }
+        armScheduleTimer();
+    }
+
+    updateAutoGamma();
+
+    if (pollTopology()) {
+        histogram_.setMonitors(topology_.handles);
+        size_t count = getMonitorCount();
+        std::snprintf(status_text_, sizeof(status_text_), "Displays changed: %zu connected",
+                      count);
+    }
+
+    platform::GammaResult result;
+    if (!gamma_worker_.pollResult(result)) {
+        return;
+    }
+
+    if (!result.monitor_apply_ms.empty()) {
+        monitor_apply_ms_ = std::move(result.monitor_apply_ms);
+    }
+
+    if (!result.report_status) {
+        return;
+    }
+
+    using Kind = platform::GammaRequest::Kind;
+    switch (result.kind) {
+    case Kind::Apply:
+        if (result.success) {
+            size_t count = getMonitorCount();
+            std::snprintf(status_text_, sizeof(status_text_), "Applied to %zu display%s",
+                          count, count == 1 ? "" : "s");
+        } else {
+            std::snprintf(status_text_, sizeof(status_text_), "Failed to apply gamma");
+        }
+        break;
 
-    bool success;
+    case Kind::Restore:
+    case Kind::Reset:
+        if (result.success) {
+            std::snprintf(status_text_, sizeof(status_text_), "Restored captured defaults");
+        } else {
+            std::snprintf(status_text_, sizeof(status_text_), "Reset to linear");
+        }
+        break;
+    }
+}
+
+const platform::ScreenHistogram& App::getScreenHistogram(int monitor_index) const
+{
+    if (monitor_index >= 0 && static_cast<size_t>(monitor_index) < topology_.handles.size()) {
+        return histogram_.getHistogram(topology_.handles[static_cast<size_t>(monitor_index)]);
+    }
+    return histogram_.getHistogram();
+}
+
+bool App::pollTopology()
+{
+    return gamma_worker_.pollTopology(topology_);
+}
+
+platform::GammaRequest App::makeGammaRequest(platform::GammaRequest::Kind kind,
+                                             platform::ToneCurve curve, double strength) const
+{
+    platform::GammaRequest request;
+    request.kind = kind;
+    request.curve = curve;
+    request.strength = std::clamp(strength, 0.1, 9.0);
+    request.white_point_k = white_point_k_;
+    request.verify_policy = config_.verify_policy;
+    request.interpolation = custom_interpolation_;
+    return request;
+}
+
+void App::postGamma(platform::GammaRequest::Kind kind, double strength, bool report_status,
+                    double transition_ms)
+{
+    platform::GammaRequest request = makeGammaRequest(kind, tone_curve_, strength);
+    if (kind == platform::GammaRequest::Kind::Apply && config_.auto_gamma.enabled &&
+        tone_curve_ == platform::ToneCurve::Power) {
+        request.strength = std::clamp(strength * auto_factor_, 0.1, 9.0);
+    }
+    request.report_status = report_status;
+    request.transition_ms = transition_ms;
     if (tone_curve_ == platform::ToneCurve::Custom) {
-        success = gamma_.applyAll(tone_curve_, value, &custom_curve_points_);
-    } else {
-        success = gamma_.applyAll(tone_curve_, value);
+        request.custom_curve = custom_curve_points_;
     }
 
-    if (success) {
-        size_t count = gamma_.getMonitorCount();
-        std::snprintf(status_text_, sizeof(status_text_), "Applied to %zu display%s",
-                      count, count == 1 ? "" : "s");
+    // Every request carries every profile; the worker skips displays whose
+    // curve is unchanged, so editing one profile pushes one ramp
+    if (kind == platform::GammaRequest::Kind::Apply) {
+        for (const auto& profile : profiles_) {
+            platform::MonitorOverride override_entry;
+            override_entry.monitor_id = profile.monitor_id;
+            override_entry.curve = profile.curve;
+            override_entry.strength = profile.strength;
+            if (profile.curve == platform::ToneCurve::Custom) {
+                override_entry.custom_curve = profile.custom_curve_points;
+                override_entry.interpolation = profile.custom_interpolation;
+            }
+            request.overrides.push_back(std::move(override_entry));
+        }
+    }
+    gamma_worker_.post(std::move(request));
+}
+
+void App::storeCurveState()
+{
+    config_.last_gamma = current_gamma_;
+    config_.transfer_function = toneCurveToString(tone_curve_);
+    config_.white_point_k = white_point_k_;
+    config_.custom_curve_points = custom_curve_points_;
+    config_.custom_curve_smooth = custom_interpolation_ == platform::CurveInterpolation::MonotoneCubic;
+    config_.profiles.clear();
+    for (const auto& profile : profiles_) {
+        config_.profiles.push_back({wideToUtf8(profile.monitor_id), toneCurveToString(profile.curve),
+                                    profile.strength, profile.custom_curve_points,
+                                    profile.custom_interpolation ==
+                                        platform::CurveInterpolation::MonotoneCubic});
+    }
+}
+
+void App::persistConfig()
+{
+    constexpr uint32_t kCurveSections = (1u << static_cast<unsigned>(ConfigSection::Gamma)) |
+                                        (1u << static_cast<unsigned>(ConfigSection::Curves)) |
+                                        (1u << static_cast<unsigned>(ConfigSection::Profiles));
+    if (dirty_sections_ & kCurveSections) {
+        curve_library_dirty_ = true;
+    }
+    if (curve_library_dirty_) {
+        saveCurveLibrary();
+        curve_library_dirty_ = false;
+    }
+
+    storeCurveState();
+    for (size_t i = 0; i < kConfigSectionCount; ++i) {
+        if (dirty_sections_ & (1u << i)) {
+            config_sections_[i] = config_.serializeSection(static_cast<ConfigSection>(i));
+        }
+    }
+    dirty_sections_ = 0;
+
+    // Serializing a few sections is microseconds; the disk write happens
+    // on the writer thread once changes settle
+    config_writer_.post(Config::joinSections(config_sections_));
+}
+
+std::filesystem::path App::getCurveLibraryPath()
+{
+    return config_.getConfigDir() / L"curves.bin";
+}
+
+void App::loadCurveLibrary()
+{
+    // Runs before the worker takes over gamma_: the saved curve posted at
+    // startup then finds its ideal and accepted ramps already cached
+    platform::CurveLibrary library;
+    if (!library.open(getCurveLibraryPath())) {
+        return;
+    }
+
+    for (size_t i = 0; i < library.size(); ++i) {
+        platform::CurveLibrary::View record = library.record(i);
+        if (record.kind == platform::CurveLibraryRecord::Accepted) {
+            gamma_.seedAcceptedRamp(std::wstring(record.monitor_id), record.key, *record.ramp);
+            continue;
+        }
+
+        // A custom ramp is only reused if its points still hash to its key
+        if (record.key.curve == platform::ToneCurve::Custom) {
+            std::vector<platform::CurvePoint> points(record.points,
+                                                     record.points + record.point_count);
+            uint64_t hash = platform::Gamma::hashCurvePoints(points);
+            if (record.key.curve_hash != hash && record.key.curve_hash != ~hash) continue;
+        }
+        gamma_.seedBuiltRamp(record.key, *record.ramp);
+    }
+}
+
+void App::saveCurveLibrary()
+{
+    // The curves in use (app-wide and per display) plus what each display
+    // has accepted. The writer thread builds the ramps and skips the write
+    // if nothing it would store changed.
+    std::vector<LibraryCurve> curves;
+    auto add_curve = [&](platform::ToneCurve curve, double strength,
+                         const std::vector<platform::CurvePoint>& points,
+                         platform::CurveInterpolation interpolation) {
+        LibraryCurve entry;
+        entry.curve = curve;
+        entry.strength = strength;
+        if (curve == platform::ToneCurve::Custom) entry.points = points;
+        entry.interpolation = interpolation;
+        entry.white_point_k = white_point_k_;
+        curves.push_back(std::move(entry));
+    };
+
+    add_curve(tone_curve_, current_gamma_, custom_curve_points_, custom_interpolation_);
+    for (const auto& profile : profiles_) {
+        add_curve(profile.curve, profile.strength, profile.custom_curve_points,
+                  profile.custom_interpolation);
+    }
+
+    config_writer_.postCurveLibrary(std::move(curves), accepted_ramps_);
+}
+
+const DisplayProfile* App::findProfile(size_t monitor_index) const
+{
+    if (monitor_index >= topology_.device_ids.size()) return nullptr;
+    const std::wstring& id = topology_.device_ids[monitor_index];
+    auto it = std::find_if(profiles_.begin(), profiles_.end(),
+                           [&](const DisplayProfile& p) { return p.monitor_id == id; });
+    return (it != profiles_.end()) ? &*it : nullptr;
+}
+
+const DisplayProfile* App::editProfile() const
+{
+    int index = getEditMonitor();
+    return (index >= 0) ? findProfile(static_cast<size_t>(index)) : nullptr;
+}
+
+DisplayProfile* App::editProfile()
+{
+    return const_cast<DisplayProfile*>(std::as_const(*this).editProfile());
+}
+
+double App::getGamma() const
+{
+    const DisplayProfile* profile = editProfile();
+    return profile ? profile->strength : current_gamma_;
+}
+
+platform::ToneCurve App::getToneCurve() const
+{
+    const DisplayProfile* profile = editProfile();
+    return profile ? profile->curve : tone_curve_;
+}
+
+const std::vector<platform::CurvePoint>& App::getCustomCurvePoints() const
+{
+    const DisplayProfile* profile = editProfile();
+    return profile ? profile->custom_curve_points : custom_curve_points_;
+}
+
+platform::CurveInterpolation App::getCustomCurveInterpolation() const
+{
+    const DisplayProfile* profile = editProfile();
+    return profile ? profile->custom_interpolation : custom_interpolation_;
+}
+
+int App::getEditMonitor() const
+{
+    if (edit_monitor_id_.empty()) return -1;
+    auto it = std::find(topology_.device_ids.begin(), topology_.device_ids.end(), edit_monitor_id_);
+    return (it != topology_.device_ids.end())
+        ? static_cast<int>(it - topology_.device_ids.begin()) : -1;
+}
+
+void App::setEditMonitor(int monitor_index)
+{
+    if (monitor_index < 0 || static_cast<size_t>(monitor_index) >= topology_.device_ids.size()) {
+        edit_monitor_id_.clear();
+        return;
+    }
+    edit_monitor_id_ = topology_.device_ids[static_cast<size_t>(monitor_index)];
+}
+
+bool App::hasDisplayProfile(size_t monitor_index) const
+{
+    return findProfile(monitor_index) != nullptr;
+}
+
+void App::setDisplayProfileEnabled(size_t monitor_index, bool enabled)
+{
+    if (monitor_index >= topology_.device_ids.size()) return;
+    if (hasDisplayProfile(monitor_index) == enabled) return;
+
+    const std::wstring& id = topology_.device_ids[monitor_index];
+    markConfigDirty(ConfigSection::Profiles);
+    if (enabled) {
+        // Starts out as the app-wide curve, so nothing needs pushing yet
+        profiles_.push_back({id, tone_curve_, current_gamma_, custom_curve_points_,
+                             custom_interpolation_});
+        return;
+    }
+
+    profiles_.erase(std::remove_if(profiles_.begin(), profiles_.end(),
+                                   [&](const DisplayProfile& p) { return p.monitor_id == id; }),
+                    profiles_.end());
+    if (gamma_enabled_) {
+        postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, true);
+    }
+}
+
+void App::setGamma(double value)
+{
+    value = std::clamp(value, 0.1, 9.0);
+    if (DisplayProfile* profile = editProfile()) {
+        profile->strength = value;
+        markConfigDirty(ConfigSection::Profiles);
     } else {
-        std::snprintf(status_text_, sizeof(status_text_), "Failed to apply gamma");
+        current_gamma_ = value;
+        markConfigDirty(ConfigSection::Gamma);
+    }
+
+    // Latest value wins: a fast slider drag only applies what the worker
+    // can keep up with, the UI never waits for the driver
+    postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, true);
+}
+
+void App::setWhitePoint(double kelvin, bool fade)
+{
+    white_point_k_ = std::clamp(kelvin, platform::kMinWhitePointK, platform::kMaxWhitePointK);
+    markConfigDirty(ConfigSection::Gamma);
+    if (gamma_enabled_) {
+        postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, true,
+                  fade ? config_.transition_ms : 0.0);
     }
 }
 
 void App::setToneCurve(platform::ToneCurve curve)
 {
-    tone_curve_ = curve;
+    if (DisplayProfile* profile = editProfile()) {
+        profile->curve = curve;
+        markConfigDirty(ConfigSection::Profiles);
+    } else {
+        tone_curve_ = curve;
+        markConfigDirty(ConfigSection::Gamma);
+    }
     // Reapply current strength with new tone curve
-    setGamma(current_gamma_);
+    postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, true);
 }
 
 void App::adjustGamma(double delta)
 {
-    setGamma(current_gamma_ + delta);
+    // Hotkey steps fade; repeated presses retarget the running fade
+    current_gamma_ = std::clamp(current_gamma_ + delta, 0.1, 9.0);
+    markConfigDirty(ConfigSection::Gamma);
+    postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, true, config_.transition_ms);
 }
 
 void App::resetGamma()
 {
     current_gamma_ = 1.0;
+    markConfigDirty(ConfigSection::Gamma);
 
-    if (gamma_.restoreAll()) {
-        std::snprintf(status_text_, sizeof(status_text_), "Restored captured defaults");
-    } else {
-        if (tone_curve_ == platform::ToneCurve::Custom) {
-            gamma_.applyAll(tone_curve_, 1.0, &custom_curve_points_);
-        } else {
-            gamma_.applyAll(tone_curve_, 1.0);
-        }
-        std::snprintf(status_text_, sizeof(status_text_), "Reset to linear");
-    }
+    // Restores captured ramps; falls back to the curve at 1.0 if that fails
+    postGamma(platform::GammaRequest::Kind::Reset, 1.0, true, config_.transition_ms);
 }
 
 void App::setCustomCurvePoints(const std::vector<platform::CurvePoint>& points)
 {
-    custom_curve_points_ = points;
+    DisplayProfile* profile = editProfile();
+    (profile ? profile->custom_curve_points : custom_curve_points_) = points;
+    markConfigDirty(profile ? ConfigSection::Profiles : ConfigSection::Curves);
 
     // If we're currently in Custom mode, reapply immediately
-    if (tone_curve_ == platform::ToneCurve::Custom) {
-        setGamma(current_gamma_);
+    if (getToneCurve() == platform::ToneCurve::Custom) {
+        postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, true);
+    }
+}
+
+void App::setCustomCurveInterpolation(platform::CurveInterpolation interpolation)
+{
+    DisplayProfile* profile = editProfile();
+    (profile ? profile->custom_interpolation : custom_interpolation_) = interpolation;
+    markConfigDirty(profile ? ConfigSection::Profiles : ConfigSection::Curves);
+    if (getToneCurve() == platform::ToneCurve::Custom) {
+        postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, true);
     }
 }
 
 void App::showWindow()
 {
+    // The agent has no renderer to show
+    if (mode_ == AppMode::Agent) return;
+
     if (hwnd_) {
         ShowWindow(hwnd_, SW_SHOW);
         SetForegroundWindow(hwnd_);
     }
     window_visible_ = true;
+
+    // The histogram is only drawn in the window, sample while it's open
+    updateHistogramCapture();
 }
 
 void App::hideWindow()
@@ -204,6 +612,22 @@ void App::hideWindow()
         ShowWindow(hwnd_, SW_HIDE);
     }
     window_visible_ = false;
+
+    // Auto gamma keeps sampling from the tray
+    updateHistogramCapture();
+}
+
+void App::updateHistogramCapture()
+{
+    // A disconnected session has no screen and a locked one shows the
+    // secure desktop; capturing either only burns CPU
+    bool wanted = session_connected_ && !session_locked_ &&
+                  (window_visible_ || config_.auto_gamma.enabled);
+    if (wanted) {
+        histogram_.start();
+    } else {
+        histogram_.stop();
+    }
 }
 
 void App::showHelp()
@@ -240,6 +664,252 @@ bool App::handleHotkeyMessage(WPARAM wParam)
     return hotkeys_.handleMessage(wParam);
 }
 
+void App::handleDisplayChange()
+{
+    // Plugging a display in typically sends several of these; the worker
+    // waits for them to stop, then diffs the monitor list once
+    gamma_worker_.requestTopologyRescan();
+}
+
+void App::handleSessionChange(WPARAM event)
+{
+    switch (event) {
+    case WTS_CONSOLE_DISCONNECT:
+    case WTS_REMOTE_DISCONNECT:
+        session_connected_ = false;
+        break;
+
+    case WTS_SESSION_LOCK:
+        session_locked_ = true;
+        break;
+
+    case WTS_CONSOLE_CONNECT:
+    case WTS_REMOTE_CONNECT:
+    case WTS_SESSION_LOGON:
+    case WTS_SESSION_UNLOCK:
+        // Reconnecting swaps the session's display adapter (console <-> RDP)
+        // and can leave identity ramps behind; the rescan re-reads every
+        // monitor and reapplies any that no longer show the current curve
+        session_connected_ = true;
+        if (event != WTS_CONSOLE_CONNECT && event != WTS_REMOTE_CONNECT) {
+            session_locked_ = false;
+        }
+        gamma_worker_.requestTopologyRescan();
+        break;
+
+    default:
+        return;
+    }
+    updateHistogramCapture();
+}
+
+void App::setAutoGamma(const AutoGammaSettings& settings)
+{
+    bool was_enabled = config_.auto_gamma.enabled;
+    config_.auto_gamma = settings;
+    markConfigDirty(ConfigSection::AutoGamma);
+    if (settings.enabled == was_enabled) return;
+
+    auto_gamma_.reset();
+    auto_factor_ = 1.0;
+    auto_histogram_generation_ = histogram_.getHistogram().generation;
+
+    updateHistogramCapture();
+
+    // Turning it off drops the factor; turning it on waits for a sample
+    if (!settings.enabled && gamma_enabled_ && tone_curve_ == platform::ToneCurve::Power) {
+        postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, false, kAutoGammaFadeMs);
+    }
+}
+
+void App::updateAutoGamma()
+{
+    if (!config_.auto_gamma.enabled) return;
+
+    const platform::ScreenHistogram& histogram = histogram_.getHistogram();
+    if (histogram.generation == auto_histogram_generation_) return;
+    auto_histogram_generation_ = histogram.generation;
+
+    double factor = 1.0;
+    double now_ms = static_cast<double>(GetTickCount64());
+    if (!auto_gamma_.update(histogram, config_.auto_gamma, current_gamma_, now_ms, factor)) {
+        return;
+    }
+    auto_factor_ = factor;
+
+    // Toggled off or on a fixed-shape curve: keep tracking, don't push
+    if (gamma_enabled_ && tone_curve_ == platform::ToneCurve::Power) {
+        postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, false, kAutoGammaFadeMs);
+    }
+}
+
+void App::handleTimeChange()
+{
+    // Due times are absolute, but an event may have been skipped while the
+    // clock jumped; catch up with whatever should be in effect now
+    syncSchedule();
+}
+
+void App::setScheduleEnabled(bool enabled)
+{
+    config_.schedule.enabled = enabled;
+    markConfigDirty(ConfigSection::Schedule);
+    syncSchedule();
+}
+
+void App::setScheduleLocation(double latitude, double longitude)
+{
+    config_.schedule.latitude = std::clamp(latitude, -90.0, 90.0);
+    config_.schedule.longitude = std::clamp(longitude, -180.0, 180.0);
+    markConfigDirty(ConfigSection::Schedule);
+    if (config_.schedule.enabled) {
+        armScheduleTimer();
+    }
+}
+
+bool App::getNextScheduleEvent(ScheduleEvent& out) const
+{
+    if (!schedule_armed_) return false;
+    out = next_schedule_event_;
+    return true;
+}
+
+bool App::exportPerfTrace(std::string& out_path)
+{
+    SYSTEMTIME now;
+    GetLocalTime(&now);
+    wchar_t name[64];
+    std::swprintf(name, 64, L"lumos-trace-%04d%02d%02d-%02d%02d%02d.json", now.wYear,
+                  now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond);
+
+    std::filesystem::path dir = config_.getConfigDir();
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::filesystem::path path = dir / name;
+
+    out_path = wideToUtf8(path.wstring());
+    return platform::exportPerfTrace(path);
+}
+
+void App::syncSchedule()
+{
+    const ScheduleSettings& schedule = config_.schedule;
+    if (!schedule.enabled) {
+        if (schedule_timer_) CancelWaitableTimer(schedule_timer_);
+        schedule_armed_ = false;
+        return;
+    }
+
+    ScheduleEvent current;
+    if (currentScheduleEvent(schedule, currentUtcTicks(), current)) {
+        applyScheduleEntry(schedule.entries[current.entry], 0.0);
+    }
+    armScheduleTimer();
+}
+
+void App::armScheduleTimer()
+{
+    schedule_armed_ = false;
+    if (!schedule_timer_ || !config_.schedule.enabled) return;
+
+    ScheduleEvent next;
+    if (!nextScheduleEvent(config_.schedule, currentUtcTicks(), next)) {
+        CancelWaitableTimer(schedule_timer_);
+        return;
+    }
+
+    // Positive due time = absolute UTC FILETIME
+    LARGE_INTEGER due;
+    due.QuadPart = static_cast<LONGLONG>(next.utc_ticks);
+    if (SetWaitableTimer(schedule_timer_, &due, 0, nullptr, nullptr, FALSE)) {
+        next_schedule_event_ = next;
+        schedule_armed_ = true;
+    }
+}
+
+void App::applyScheduleEntry(const ScheduleEntry& entry, double fade_ms)
+{
+    tone_curve_ = stringToToneCurve(entry.curve);
+    current_gamma_ = std::clamp(entry.strength, 0.1, 9.0);
+    markConfigDirty(ConfigSection::Gamma);
+    if (entry.white_point_k > 0.0) {
+        white_point_k_ = std::clamp(entry.white_point_k, platform::kMinWhitePointK,
+                                    platform::kMaxWhitePointK);
+    }
+
+    // While toggled off, the entry becomes what toggling on restores
+    if (!gamma_enabled_) {
+        gamma_before_disable_ = current_gamma_;
+        return;
+    }
+
+    postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, false, fade_ms);
+    std::snprintf(status_text_, sizeof(status_text_), "Schedule: %s %.2f",
+                  entry.curve.c_str(), current_gamma_);
+}
+
+bool App::handleRemoteCommand(const std::string& payload)
+{
+    auto args = Cli::fromCommand(payload);
+    if (!args) {
+        return false;
+    }
+
+    // A second GUI launch just brings this one up (the agent has no window)
+    if (args->action == CliAction::ShowGui) {
+        showWindow();
+        return mode_ == AppMode::Window;
+    }
+
+    if (args->action == CliAction::ExitInstance) {
+        requestExit();
+        return true;
+    }
+
+    std::vector<platform::CurvePoint> custom;
+    if (args->curve == platform::ToneCurve::Custom) {
+        custom = CurveIO::loadCurve(args->curve_file);
+        if (custom.empty()) {
+            return false;
+        }
+    }
+
+    // Whole-desktop requests become the app's state, same as the slider
+    if (args->monitors.empty() && !args->primary_monitor) {
+        if (!custom.empty()) {
+            custom_curve_points_ = std::move(custom);
+            markConfigDirty(ConfigSection::Curves);
+        }
+        tone_curve_ = args->curve;
+        current_gamma_ = std::clamp(args->gamma_value, 0.1, 9.0);
+        markConfigDirty(ConfigSection::Gamma);
+        // An explicit apply turns gamma back on, so the UI and tray match
+        // the display and the next toggle starts from this strength
+        gamma_enabled_ = true;
+        postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, true);
+        return true;
+    }
+
+    // Per-display requests leave the app-wide curve alone
+    std::vector<size_t> targets = args->monitors;
+    if (args->primary_monitor &&
+        std::find(targets.begin(), targets.end(), topology_.primary_index) == targets.end()) {
+        targets.push_back(topology_.primary_index);
+    }
+    for (size_t index : targets) {
+        if (index >= getMonitorCount()) {
+            return false;
+        }
+    }
+
+    platform::GammaRequest request = makeGammaRequest(platform::GammaRequest::Kind::Apply,
+                                                      args->curve, args->gamma_value);
+    request.custom_curve = std::move(custom);
+    request.monitors = std::move(targets);
+    gamma_worker_.post(std::move(request));
+    return true;
+}
+
 bool App::setHotkeys(const HotkeyBinding& increase,
                      const HotkeyBinding& decrease,
                      const HotkeyBinding& reset,
@@ -254,6 +924,7 @@ bool App::setHotkeys(const HotkeyBinding& increase,
         config_.hotkey_decrease = decrease;
         config_.hotkey_reset = reset;
         config_.hotkey_toggle = toggle;
+        markConfigDirty(ConfigSection::Hotkeys);
         hotkey_error_[0] = '\0';
         std::snprintf(status_text_, sizeof(status_text_), "Hotkeys updated");
     } else {
@@ -275,18 +946,16 @@ void App::toggleGamma()
     if (gamma_enabled_) {
         // Disable: store current gamma and restore original
         gamma_before_disable_ = current_gamma_;
-        gamma_.restoreAll();
+        postGamma(platform::GammaRequest::Kind::Restore, current_gamma_, false,
+                  config_.transition_ms);
         gamma_enabled_ = false;
         std::snprintf(status_text_, sizeof(status_text_), "Gamma OFF");
     } else {
         // Enable: reapply the stored gamma value
         gamma_enabled_ = true;
-        if (tone_curve_ == platform::ToneCurve::Custom) {
-            gamma_.applyAll(tone_curve_, gamma_before_disable_, &custom_curve_points_);
-        } else {
-            gamma_.applyAll(tone_curve_, gamma_before_disable_);
-        }
         current_gamma_ = gamma_before_disable_;
+        postGamma(platform::GammaRequest::Kind::Apply, current_gamma_, false,
+                  config_.transition_ms);
         std::snprintf(status_text_, sizeof(status_text_), "Gamma ON (%.1f)", current_gamma_);
     }
 }
@@ -294,6 +963,7 @@ void App::toggleGamma()
 void App::setAlwaysOnTop(bool value)
 {
     config_.always_on_top = value;
+    markConfigDirty(ConfigSection::Window);
     if (hwnd_) {
         SetWindowPos(hwnd_,
                      value ? HWND_TOPMOST : HWND_NOTOPMOST,
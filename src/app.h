@@ -5,7 +5,10 @@
 #pragma once
 
 #include "config.h"
+#include "config_writer.h"
 #include "platform/win32/gamma.h"
+#include "platform/win32/gamma_worker.h"
+#include "platform/win32/perf_trace.h"
 #include "platform/win32/screen_histogram.h"
 #include "platform/win32/tray.h"
 #include "platform/win32/hotkeys.h"
@@ -19,21 +22,48 @@
 #endif
 
 #include <windows.h>
+#include <algorithm>
+#include <array>
+#include <filesystem>
 #include <functional>
+#include <string>
 
 namespace lumos {
 
+// A display with its own curve instead of the app-wide one
+struct DisplayProfile {
+    std::wstring monitor_id;  // MonitorInfo::device_id
+    platform::ToneCurve curve = platform::ToneCurve::Power;
+    double strength = 1.0;
+    std::vector<platform::CurvePoint> custom_curve_points;
+    platform::CurveInterpolation custom_interpolation = platform::CurveInterpolation::Linear;
+};
+
+// Window: the normal GUI (tray icon, renderer while visible).
+// Agent: headless per-session instance (lumos --agent) for shared terminal
+// servers; the window stays hidden, no renderer, tray icon or histogram
+// unless auto gamma needs one. Controlled through the command channel.
+enum class AppMode {
+    Window,
+    Agent,
+};
+
 class App {
 public:
     App() = default;
 
     // Initialize application (call after window creation)
-    bool initialize(HWND hwnd, UINT tray_msg);
+    bool initialize(HWND hwnd, UINT tray_msg, AppMode mode = AppMode::Window);
+    bool isAgent() const { return mode_ == AppMode::Agent; }
 
     // Shutdown application (call before exit)
     void shutdown();
 
-    // Set gamma value (applies immediately to all monitors)
+    // Pick up completed background work (call once per main loop iteration)
+    void update();
+
+    // Set gamma value (queued to the apply worker; only displays whose
+    // curve changed are pushed)
     void setGamma(double value);
 
     // Set tone curve preset (applies immediately)
@@ -46,14 +76,32 @@ public:
     void resetGamma();
 
     // Get current gamma value
-    double getGamma() const { return current_gamma_; }
+    double getGamma() const;
+
+    // Color temperature applied on top of the curve (6500 K = neutral).
+    // Changes fade like toggle/reset.
+    double getWhitePoint() const { return white_point_k_; }
+    void setWhitePoint(double kelvin, bool fade = false);
 
     // Get current tone curve preset
-    platform::ToneCurve getToneCurve() const { return tone_curve_; }
+    platform::ToneCurve getToneCurve() const;
 
     // Custom curve management
-    const std::vector<platform::CurvePoint>& getCustomCurvePoints() const { return custom_curve_points_; }
+    const std::vector<platform::CurvePoint>& getCustomCurvePoints() const;
     void setCustomCurvePoints(const std::vector<platform::CurvePoint>& points);
+    platform::CurveInterpolation getCustomCurveInterpolation() const;
+    void setCustomCurveInterpolation(platform::CurveInterpolation interpolation);
+
+    // Per-display curves. The curve getters and setters above act on the
+    // display being edited if it has its own profile, otherwise on the
+    // app-wide curve. Hotkeys, toggle, schedule and auto gamma stay app-wide.
+    int getEditMonitor() const;  // -1 = all displays
+    void setEditMonitor(int monitor_index);
+    bool hasDisplayProfile(size_t monitor_index) const;
+
+    // Give a display its own curve (starting from the app-wide one), or
+    // return it to the app-wide curve
+    void setDisplayProfileEnabled(size_t monitor_index, bool enabled);
 
     // Window visibility
     void showWindow();
@@ -78,6 +126,20 @@ public:
     // Handle hotkey messages
     bool handleHotkeyMessage(WPARAM wParam);
 
+    // Handle display topology changes (WM_DISPLAYCHANGE / device removal)
+    void handleDisplayChange();
+
+    // Clock changed or the system resumed: re-arm the schedule timer
+    void handleTimeChange();
+
+    // WM_WTSSESSION_CHANGE: pause capture while the session is disconnected
+    // or locked, reapply when it comes back (a reconnect brings a new display)
+    void handleSessionChange(WPARAM event);
+
+    // Command forwarded by another Lumos process (Cli::toCommand payload).
+    // Returns false if it was invalid; valid commands are queued, not awaited.
+    bool handleRemoteCommand(const std::string& payload);
+
     // Get status text for UI
     const char* getStatusText() const { return status_text_; }
 
@@ -102,46 +164,186 @@ public:
 
     // Window behavior settings
     bool getMinimizeToTrayOnClose() const { return config_.minimize_to_tray_on_close; }
-    void setMinimizeToTrayOnClose(bool value) { config_.minimize_to_tray_on_close = value; }
+    void setMinimizeToTrayOnClose(bool value)
+    {
+        config_.minimize_to_tray_on_close = value;
+        markConfigDirty(ConfigSection::Window);
+    }
 
     bool getAlwaysOnTop() const { return config_.always_on_top; }
     void setAlwaysOnTop(bool value);
 
-    // Get monitor count
-    size_t getMonitorCount() const { return gamma_.getMonitorCount(); }
+    // Histogram-driven auto gamma (Power curve only). The factor scales the
+    // user's strength; getGamma() keeps returning the unscaled value.
+    const AutoGammaSettings& getAutoGamma() const { return config_.auto_gamma; }
+    void setAutoGamma(const AutoGammaSettings& settings);
+    bool isAutoGammaEnabled() const { return config_.auto_gamma.enabled; }
+    double getAutoGammaFactor() const { return auto_factor_; }
+    double getAutoGammaMedian() const { return auto_gamma_.median(); }
+
+    // Time-of-day schedule
+    const ScheduleSettings& getSchedule() const { return config_.schedule; }
+    void setScheduleEnabled(bool enabled);
+    void setScheduleLocation(double latitude, double longitude);
+    bool getNextScheduleEvent(ScheduleEvent& out) const;
+
+    // How much of each ramp push is read back (takes effect on the next apply)
+    platform::VerifyPolicy getVerifyPolicy() const { return config_.verify_policy; }
+    void setVerifyPolicy(platform::VerifyPolicy policy)
+    {
+        config_.verify_policy = policy;
+        markConfigDirty(ConfigSection::Gamma);
+    }
+
+    // Fade duration for toggle, reset and hotkey steps (0 = instant)
+    double getTransitionMs() const { return config_.transition_ms; }
+    void setTransitionMs(double ms)
+    {
+        config_.transition_ms = std::clamp(ms, 0.0, 5000.0);
+        markConfigDirty(ConfigSection::Gamma);
+    }
+
+    // Get monitor count (as of the worker's last display rescan)
+    size_t getMonitorCount() const { return topology_.handles.size(); }
+
+    // Per-monitor duration of the last adaptive apply, in milliseconds
+    const std::vector<double>& getMonitorApplyTimes() const { return monitor_apply_ms_; }
+
+    // Display DCs created by the gamma module (diagnostics)
+    uint64_t getDcCreationCount() const { return gamma_.getDcCreationCount(); }
 
     // Get reference to gamma module (for crash handler)
     platform::Gamma& getGammaRef() { return gamma_; }
 
-    // Screen histogram access
-    platform::ScreenHistogram getScreenHistogram() const { return histogram_.getHistogram(); }
+    // Screen histogram snapshots (UI thread only, valid until the next call)
+    const platform::ScreenHistogram& getScreenHistogram() const { return histogram_.getHistogram(); }
+    const platform::ScreenHistogram& getScreenHistogram(int monitor_index) const;  // -1 = all displays
+    uint64_t getHistogramGeneration() const { return histogram_.getHistogram().generation; }
+
+    // Handles the main loop sleeps on besides window messages
+    HANDLE getGammaCompletionEvent() const { return gamma_worker_.completionEvent(); }
+    HANDLE getHistogramUpdateEvent() const { return histogram_.updateEvent(); }
+    HANDLE getScheduleTimer() const { return schedule_armed_ ? schedule_timer_ : nullptr; }
+
+    // Main loop wakeups (diagnostics: should be ~0/s while tray-resident)
+    void noteWakeup() { ++wakeup_count_; }
+    uint64_t getWakeupCount() const { return wakeup_count_; }
+    // Hot-path timers (ramp build/set/verify, histogram, frame) for the
+    // status bar overlay; off by default
+    void setPerfTracing(bool enabled) { platform::setPerfTracingEnabled(enabled); }
+    bool isPerfTracing() const { return platform::isPerfTracingEnabled(); }
+    platform::PerfStageStats getPerfStats(platform::PerfStage stage) const { return platform::getPerfStats(stage); }
+    void clearPerfTrace() { platform::clearPerfSamples(); }
+
+    // Write the collected samples to a timestamped trace file next to the
+    // config; out_path receives its location
+    bool exportPerfTrace(std::string& out_path);
+
     void setHistogramEnabled(bool enabled) { histogram_.setEnabled(enabled); }
     bool isHistogramEnabled() const { return histogram_.isEnabled(); }
+    void setGpuHistogramEnabled(bool enabled) { histogram_.setGpuHistogramEnabled(enabled); }
+    bool isGpuHistogramEnabled() const { return histogram_.isGpuHistogramEnabled(); }
+    bool isGpuHistogramActive() const { return histogram_.isGpuHistogramActive(); }
 
     // Get window handle (for native dialogs)
     void* getHwnd() const { return hwnd_; }
 
 private:
     Config config_;
+    ConfigWriter config_writer_;
+
+    // Serialized sections as last handed to config_writer_; only the dirty
+    // ones are rebuilt
+    std::array<std::string, kConfigSectionCount> config_sections_;
+    uint32_t dirty_sections_ = 0;
+    void markConfigDirty(ConfigSection section) { dirty_sections_ |= 1u << static_cast<unsigned>(section); }
+
+    // Copy curve state (kept in App members) into config_
+    void storeCurveState();
+
+    // Rebuild dirty sections and queue the file for a background write
+    void persistConfig();
     platform::Gamma gamma_;
+    platform::GammaWorker gamma_worker_;
     platform::ScreenHistogramCapture histogram_;
     platform::Tray tray_;
     platform::Hotkeys hotkeys_;
 
     HWND hwnd_ = nullptr;
+    AppMode mode_ = AppMode::Window;
     double current_gamma_ = 1.0;
     platform::ToneCurve tone_curve_ = platform::ToneCurve::Power;
+    double white_point_k_ = platform::kNeutralWhitePointK;
     std::vector<platform::CurvePoint> custom_curve_points_;
+    platform::CurveInterpolation custom_interpolation_ = platform::CurveInterpolation::Linear;
+    std::vector<DisplayProfile> profiles_;  // Includes displays not connected now
+    std::wstring edit_monitor_id_;          // Display the curve controls edit (empty = all)
+    std::vector<double> monitor_apply_ms_;
+    platform::MonitorTopology topology_;  // UI thread copy of the worker's monitor list
+    uint64_t wakeup_count_ = 0;
     bool window_visible_ = true;
+    bool session_connected_ = true;
+    bool session_locked_ = false;
     bool should_exit_ = false;
     char status_text_[64] = "Ready";
     char hotkey_error_[128] = "";
 
+    // Auto gamma state: consumes each histogram generation once
+    AutoGammaController auto_gamma_;
+    uint64_t auto_histogram_generation_ = 0;
+    double auto_factor_ = 1.0;
+    static constexpr double kAutoGammaFadeMs = 1000.0;
+
+    // Feed new histogram samples to the auto gamma controller
+    void updateAutoGamma();
+
+    // Run the histogram capture only while something uses it and the
+    // session has a screen to sample
+    void updateHistogramCapture();
+
+    // Refresh topology_ from the worker; true if the monitor list changed
+    bool pollTopology();
+
+    // Precomputed ramps kept next to the INI (see CurveLibrary), so the
+    // saved curve applies at startup without building or probing.
+    // saveCurveLibrary() queues a write on config_writer_ whenever the curves
+    // in use or the worker's accepted ramps change.
+    std::filesystem::path getCurveLibraryPath();
+    void loadCurveLibrary();
+    void saveCurveLibrary();
+    std::vector<platform::AcceptedRampRecord> accepted_ramps_;  // As last polled from the worker
+    bool curve_library_dirty_ = false;
+
+    // Profile of a display (nullptr if it follows the app-wide curve)
+    const DisplayProfile* findProfile(size_t monitor_index) const;
+    DisplayProfile* editProfile();
+    const DisplayProfile* editProfile() const;
+
+    // One waitable timer, always armed for the next schedule event only
+    HANDLE schedule_timer_ = nullptr;
+    bool schedule_armed_ = false;
+    ScheduleEvent next_schedule_event_;
+
     // Toggle state
     bool gamma_enabled_ = true;
     double gamma_before_disable_ = 1.0;
 
     static constexpr double GAMMA_STEP = 0.1;
+
+    // Apply the entry in effect now (instantly) and arm the timer for the
+    // next one; disarms when the schedule is off
+    void syncSchedule();
+    void armScheduleTimer();
+    void applyScheduleEntry(const ScheduleEntry& entry, double fade_ms);
+
+    // Request carrying the app-wide settings every ramp push needs (white
+    // point, verify policy, interpolation), with the strength clamped
+    platform::GammaRequest makeGammaRequest(platform::GammaRequest::Kind kind,
+                                            platform::ToneCurve curve, double strength) const;
+
+    // Queue a ramp operation for the given strength on the apply worker
+    void postGamma(platform::GammaRequest::Kind kind, double strength, bool report_status,
+                   double transition_ms = 0.0);
 };
 
 } // namespace lumos
@@ -0,0 +1,99 @@
+// Lumos - Histogram-driven automatic gamma
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#include "auto_gamma.h"
+#include <algorithm>
+#include <cmath>
+
+namespace lumos {
+
+namespace {
+
+// Luminance below which the given fraction of pixels lies (0-1)
+double histogramPercentile(const platform::ScreenHistogram& histogram, double fraction)
+{
+    double total = 0.0;
+    for (float bin : histogram.luminance) total += bin;
+    if (total <= 0.0) return 0.5;
+
+    double threshold = total * fraction;
+    double cumulative = 0.0;
+    for (size_t i = 0; i < histogram.luminance.size(); ++i) {
+        cumulative += histogram.luminance[i];
+        if (cumulative >= threshold) {
+            return (static_cast<double>(i) + 0.5) / 256.0;
+        }
+    }
+    return 1.0;
+}
+
+// 8-bit output level of luminance x through a Power curve of strength s
+double powerLevel(double x, double strength)
+{
+    return 255.0 * std::pow(x, 1.0 / strength);
+}
+
+} // anonymous namespace
+
+void AutoGammaController::reset()
+{
+    smoothed_factor_ = 1.0;
+    applied_factor_ = 1.0;
+    median_ = 0.5;
+    last_sample_ms_ = -1.0;
+    last_push_ms_ = -1.0;
+    last_direction_ = 0;
+}
+
+bool AutoGammaController::update(const platform::ScreenHistogram& histogram,
+                                 const AutoGammaSettings& settings,
+                                 double base_strength, double now_ms, double& out_factor)
+{
+    if (!histogram.valid) return false;
+
+    // Strength that would put the median on target. The factor multiplies
+    // the base strength, so it is the ratio of the two, applied partially.
+    median_ = std::clamp(histogramPercentile(histogram, 0.5), 0.02, 0.98);
+    double target = std::clamp(settings.target, 0.05, 0.95);
+    double ideal = std::log(median_) / std::log(target);
+    double max_boost = (std::max)(1.0, settings.max_boost);
+    double factor = std::clamp(std::pow(ideal / (std::max)(0.1, base_strength),
+                                        std::clamp(settings.amount, 0.0, 1.0)),
+                               1.0 / max_boost, max_boost);
+
+    // Exponential smoothing, time-based so it doesn't depend on the sample rate
+    if (last_sample_ms_ < 0.0) {
+        smoothed_factor_ = factor;
+    } else {
+        double dt = (std::max)(0.0, now_ms - last_sample_ms_);
+        double alpha = 1.0 - std::exp(-dt / kResponseMs);
+        smoothed_factor_ += alpha * (factor - smoothed_factor_);
+    }
+    last_sample_ms_ = now_ms;
+
+    if (last_push_ms_ >= 0.0 && now_ms - last_push_ms_ < kMinIntervalMs) {
+        return false;
+    }
+
+    double candidate = std::round(smoothed_factor_ / kFactorStep) * kFactorStep;
+    if (candidate == applied_factor_) return false;
+
+    // Perceptual threshold: how far the median moves on screen
+    double delta = powerLevel(median_, base_strength * candidate) -
+                   powerLevel(median_, base_strength * applied_factor_);
+    int direction = (delta > 0.0) ? 1 : -1;
+    double required = (last_direction_ != 0 && direction != last_direction_)
+        ? kReverseLevelDelta : kMinLevelDelta;
+    if (std::abs(delta) < required) {
+        return false;
+    }
+
+    applied_factor_ = candidate;
+    last_direction_ = direction;
+    last_push_ms_ = now_ms;
+    out_factor = candidate;
+    return true;
+}
+
+} // namespace lumos
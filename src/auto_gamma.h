@@ -0,0 +1,59 @@
+// Lumos - Histogram-driven automatic gamma
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+#include "platform/win32/screen_histogram.h"
+
+namespace lumos {
+
+struct AutoGammaSettings {
+    bool enabled = false;
+    double target = 0.45;     // Where the median luminance should land (0-1)
+    double amount = 0.5;      // How much of the correction toward target to apply (0-1)
+    double max_boost = 1.5;   // Strength factor limit, both ways
+};
+
+// Turns screen histograms into a strength factor applied on top of the
+// user's (or schedule's) Power strength: dark content is lifted, bright
+// content relaxed. The factor moves the resulting strength toward the one
+// that puts the median on target, whatever the base strength is.
+//
+// Driver calls are kept rare on purpose. The target is smoothed over a few
+// seconds, a change is only pushed when it moves the median by a visible
+// number of 8-bit levels (more when reversing direction, so a scene sitting
+// on a threshold doesn't flap), pushes are rate limited, and factors are
+// quantized so repeated values hit the accepted-ramp cache.
+class AutoGammaController {
+public:
+    // Forget history (call on enable or when the base strength changes)
+    void reset();
+
+    // Feed one histogram sample taken at now_ms. Returns true with the new
+    // factor in out_factor when a ramp push is warranted.
+    bool update(const platform::ScreenHistogram& histogram, const AutoGammaSettings& settings,
+                double base_strength, double now_ms, double& out_factor);
+
+    // Factor most recently returned by update() (1.0 after reset)
+    double factor() const { return applied_factor_; }
+
+    // Median luminance of the last sample (0-1), for display
+    double median() const { return median_; }
+
+private:
+    static constexpr double kResponseMs = 3000.0;     // Smoothing time constant
+    static constexpr double kMinIntervalMs = 2000.0;  // Between pushes
+    static constexpr double kMinLevelDelta = 2.0;     // Median shift, 8-bit levels
+    static constexpr double kReverseLevelDelta = 4.0; // Same, when changing direction
+    static constexpr double kFactorStep = 0.02;       // Quantization of the factor
+
+    double smoothed_factor_ = 1.0;
+    double applied_factor_ = 1.0;
+    double median_ = 0.5;
+    double last_sample_ms_ = -1.0;
+    double last_push_ms_ = -1.0;
+    int last_direction_ = 0;
+};
+
+} // namespace lumos
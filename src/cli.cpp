@@ -3,6 +3,8 @@
 // License: GPL v2
 
 #include "cli.h"
+#include "config.h"
+#include "platform/win32/instance_channel.h"
 
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
@@ -10,13 +12,62 @@
 
 #include <windows.h>
 #include <shellapi.h>
+#include <algorithm>
+#include <cctype>
 #include <cstdio>
 #include <cstdlib>
+#include <filesystem>
+#include <sstream>
 #include <string>
 #include <vector>
 
 namespace lumos {
 
+namespace {
+
+// Attach to the parent console (if any) so printf output is visible
+void attachConsole()
+{
+    static bool attached = false;
+    if (attached) return;
+    attached = true;
+
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        FILE* fp = nullptr;
+        freopen_s(&fp, "CONOUT$", "w", stdout);
+        freopen_s(&fp, "CONOUT$", "w", stderr);
+    }
+}
+
+double elapsedMs(const LARGE_INTEGER& start, const LARGE_INTEGER& end, const LARGE_INTEGER& freq)
+{
+    return static_cast<double>(end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart;
+}
+
+// Time since the process was created (covers loader and CRT startup)
+double processAgeMs()
+{
+    FILETIME creation, exit_time, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit_time, &kernel, &user)) {
+        return 0.0;
+    }
+    FILETIME now;
+    GetSystemTimePreciseAsFileTime(&now);
+
+    ULARGE_INTEGER a, b;
+    a.LowPart = creation.dwLowDateTime;
+    a.HighPart = creation.dwHighDateTime;
+    b.LowPart = now.dwLowDateTime;
+    b.HighPart = now.dwHighDateTime;
+    return static_cast<double>(b.QuadPart - a.QuadPart) / 10000.0;  // 100 ns units
+}
+
+// How long a CLI invocation waits on the running instance before applying
+// by itself (only reached if that instance is hung)
+constexpr DWORD kForwardTimeoutMs = 2000;
+
+} // anonymous namespace
+
 std::optional<double> Cli::parseGammaValue(const std::string& str)
 {
     try {
@@ -39,6 +90,49 @@ std::optional<double> Cli::parseGammaValue(const std::string& str)
     }
 }
 
+std::optional<platform::ToneCurve> Cli::parseToneCurve(const std::string& str)
+{
+    std::string name = str;
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (name == "linear" || name == "neutral") return platform::ToneCurve::Linear;
+    if (name == "power" || name == "gamma") return platform::ToneCurve::Power;
+    if (name == "shadowlift") return platform::ToneCurve::ShadowLift;
+    if (name == "softcontrast") return platform::ToneCurve::SoftContrast;
+    if (name == "cinema") return platform::ToneCurve::Cinema;
+    if (name == "custom") return platform::ToneCurve::Custom;
+    return std::nullopt;
+}
+
+bool Cli::parseMonitorList(const std::string& str, CliArgs& args)
+{
+    // "primary", or 1-based display numbers: "2" or "1,3"
+    if (str == "primary") {
+        args.primary_monitor = true;
+        return true;
+    }
+
+    size_t start = 0;
+    while (start <= str.size()) {
+        size_t comma = str.find(',', start);
+        std::string item = str.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        char* end = nullptr;
+        long number = std::strtol(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || number < 1) {
+            return false;
+        }
+        size_t index = static_cast<size_t>(number - 1);
+        if (std::find(args.monitors.begin(), args.monitors.end(), index) == args.monitors.end()) {
+            args.monitors.push_back(index);
+        }
+
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return true;
+}
+
 CliArgs Cli::parse(int argc, char* argv[])
 {
     CliArgs args;
@@ -60,16 +154,66 @@ CliArgs Cli::parse(int argc, char* argv[])
         return args;
     }
 
-    // Try to parse as gamma value
-    auto gamma = parseGammaValue(arg1);
-    if (gamma.has_value()) {
-        args.action = CliAction::SetGamma;
-        args.gamma_value = gamma.value();
+    if (arg1 == "--agent") {
+        args.action = CliAction::RunAgent;
         return args;
     }
 
-    // Unknown argument, show GUI
-    args.action = CliAction::ShowGui;
+    if (arg1 == "--exit") {
+        args.action = CliAction::ExitInstance;
+        return args;
+    }
+
+    auto fail = [&args](std::string message) {
+        args.action = CliAction::InvalidArgs;
+        args.error = std::move(message);
+        return args;
+    };
+
+    // Apply options (any order): <value> --curve --strength --file --monitor --bench
+    bool apply = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        if (arg == "--curve") {
+            if (!has_value) return fail("--curve needs a curve name");
+            auto curve = parseToneCurve(argv[++i]);
+            if (!curve) return fail(std::string("Unknown curve: ") + argv[i]);
+            args.curve = *curve;
+        } else if (arg == "--strength") {
+            if (!has_value) return fail("--strength needs a value");
+            auto value = parseGammaValue(argv[++i]);
+            if (!value) return fail(std::string("Strength must be 0.1-9.0: ") + argv[i]);
+            args.gamma_value = *value;
+        } else if (arg == "--file") {
+            if (!has_value) return fail("--file needs a .curve path");
+            args.curve_file = argv[++i];
+            args.curve = platform::ToneCurve::Custom;
+        } else if (arg == "--monitor") {
+            if (!has_value) return fail("--monitor needs a display number or \"primary\"");
+            if (!parseMonitorList(argv[++i], args)) {
+                return fail(std::string("Invalid display list: ") + argv[i]);
+            }
+        } else if (arg == "--bench") {
+            args.bench = true;
+        } else if (auto gamma = parseGammaValue(arg)) {
+            args.gamma_value = *gamma;
+        } else if (apply) {
+            return fail("Unknown argument: " + arg);
+        } else {
+            // Unknown argument, show GUI
+            args.action = CliAction::ShowGui;
+            return args;
+        }
+        apply = true;
+    }
+
+    if (args.curve == platform::ToneCurve::Custom && args.curve_file.empty()) {
+        return fail("--curve custom needs --file <path>");
+    }
+
+    args.action = CliAction::SetGamma;
     return args;
 }
 
@@ -83,36 +227,245 @@ CliArgs Cli::parse(const wchar_t* cmdLine)
         return CliArgs{};
     }
 
-    // Convert first argument to narrow string
-    std::string arg1;
-    int len = WideCharToMultiByte(CP_UTF8, 0, argv[1], -1, nullptr, 0, nullptr, nullptr);
-    if (len > 0) {
-        arg1.resize(len - 1);
-        WideCharToMultiByte(CP_UTF8, 0, argv[1], -1, arg1.data(), len, nullptr, nullptr);
+    // Convert arguments to narrow (UTF-8) strings
+    std::vector<std::string> narrow(argc);
+    for (int i = 0; i < argc; ++i) {
+        int len = WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, nullptr, 0, nullptr, nullptr);
+        if (len > 0) {
+            narrow[i].resize(len - 1);
+            WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, narrow[i].data(), len, nullptr, nullptr);
+        }
     }
 
     LocalFree(argv);
 
     // Parse using string version
-    const char* args[] = { "lumos", arg1.c_str() };
-    return parse(2, const_cast<char**>(args));
+    std::vector<char*> args;
+    for (auto& arg : narrow) {
+        args.push_back(arg.data());
+    }
+    return parse(argc, args.data());
 }
 
-void Cli::printHelp()
+std::string Cli::toCommand(const CliArgs& args)
 {
-    // Attach to parent console if available
-    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
-        FILE* fp = nullptr;
-        freopen_s(&fp, "CONOUT$", "w", stdout);
+    std::ostringstream out;
+    const char* command = "show";
+    if (args.action == CliAction::SetGamma) command = "apply";
+    if (args.action == CliAction::ExitInstance) command = "exit";
+    out << "command=" << command << "\n";
+    if (args.action == CliAction::SetGamma) {
+        out << "curve=" << static_cast<int>(args.curve) << "\n";
+        out << "strength=" << args.gamma_value << "\n";
+        if (!args.curve_file.empty()) {
+            out << "file=" << args.curve_file << "\n";
+        }
+        if (!args.monitors.empty()) {
+            out << "monitors=";
+            for (size_t i = 0; i < args.monitors.size(); ++i) {
+                out << (i > 0 ? "," : "") << (args.monitors[i] + 1);
+            }
+            out << "\n";
+        }
+        if (args.primary_monitor) {
+            out << "primary=1\n";
+        }
     }
+    return out.str();
+}
+
+std::optional<CliArgs> Cli::fromCommand(const std::string& command)
+{
+    CliArgs args;
+    bool has_command = false;
+
+    std::istringstream in(command);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+
+        if (key == "command") {
+            if (value == "apply") {
+                args.action = CliAction::SetGamma;
+            } else if (value == "show") {
+                args.action = CliAction::ShowGui;
+            } else if (value == "exit") {
+                args.action = CliAction::ExitInstance;
+            } else {
+                return std::nullopt;
+            }
+            has_command = true;
+        } else if (key == "curve") {
+            int curve = std::atoi(value.c_str());
+            if (curve < 0 || curve >= static_cast<int>(platform::kToneCurveCount)) {
+                return std::nullopt;
+            }
+            args.curve = static_cast<platform::ToneCurve>(curve);
+        } else if (key == "strength") {
+            auto strength = parseGammaValue(value);
+            if (!strength) return std::nullopt;
+            args.gamma_value = *strength;
+        } else if (key == "file") {
+            args.curve_file = value;
+        } else if (key == "monitors") {
+            if (!parseMonitorList(value, args)) return std::nullopt;
+        } else if (key == "primary") {
+            args.primary_monitor = (value == "1");
+        }
+    }
+
+    if (!has_command) {
+        return std::nullopt;
+    }
+    return args;
+}
+
+int Cli::runApply(const CliArgs& args)
+{
+    LARGE_INTEGER freq, t_start, t_init, t_load, t_apply;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t_start);
+    double startup_ms = args.bench ? processAgeMs() : 0.0;
+
+    // A running tray instance applies it with its warm Gamma state, so its
+    // slider and adaptive scales stay in sync. The receiver may have a
+    // different working directory, so curve paths go across absolute.
+    if (HWND instance = platform::findRunningInstance()) {
+        CliArgs forwarded = args;
+        if (!forwarded.curve_file.empty()) {
+            std::error_code ec;
+            auto absolute = std::filesystem::absolute(utf8ToWide(forwarded.curve_file), ec);
+            if (!ec) {
+                forwarded.curve_file = wideToUtf8(absolute.wstring());
+            }
+        }
+
+        auto reply = platform::sendCommand(instance, toCommand(forwarded), kForwardTimeoutMs);
+        if (reply) {
+            QueryPerformanceCounter(&t_apply);
+            if (args.bench) {
+                attachConsole();
+                std::printf("\nLumos bench\n");
+                std::printf("  Process start to send:   %8.2f ms\n", startup_ms);
+                std::printf("  Round trip to instance:  %8.2f ms\n", elapsedMs(t_start, t_apply, freq));
+                std::printf("  Total:                   %8.2f ms\n",
+                            startup_ms + elapsedMs(t_start, t_apply, freq));
+                std::printf("  Result:                  %s\n\n",
+                            *reply == platform::CommandReply::Accepted ? "forwarded" : "rejected");
+            }
+            if (*reply == platform::CommandReply::Rejected) {
+                printError("The running instance rejected the request");
+                return 2;
+            }
+            return 0;
+        }
+        // Not delivered: apply here instead
+    }
+
+    // Only monitor handles are needed; adaptive scales start fresh
+    platform::GammaInitOptions options;
+    options.capture_original_ramps = false;
+    options.resolve_device_ids = false;
+
+    platform::Gamma gamma;
+    gamma.initialize(options);
+    QueryPerformanceCounter(&t_init);
+
+    std::vector<platform::CurvePoint> custom;
+    if (args.curve == platform::ToneCurve::Custom) {
+        custom = CurveIO::loadCurve(args.curve_file);
+        if (custom.empty()) {
+            printError("Could not load curve file: " + args.curve_file);
+            return 2;
+        }
+    }
+    const std::vector<platform::CurvePoint>* custom_curve = custom.empty() ? nullptr : &custom;
+    QueryPerformanceCounter(&t_load);
+
+    bool success = true;
+    size_t applied = 0;
+    if (!args.primary_monitor && args.monitors.empty()) {
+        success = gamma.applyAll(args.curve, args.gamma_value, custom_curve);
+        applied = gamma.getMonitorCount();
+    } else {
+        std::vector<size_t> targets = args.monitors;
+        size_t primary = gamma.getPrimaryIndex();
+        if (args.primary_monitor &&
+            std::find(targets.begin(), targets.end(), primary) == targets.end()) {
+            targets.push_back(primary);
+        }
+        for (size_t index : targets) {
+            if (index >= gamma.getMonitorCount()) {
+                printError("No display " + std::to_string(index + 1));
+                success = false;
+                continue;
+            }
+            success = gamma.apply(index, args.curve, args.gamma_value, custom_curve) && success;
+            ++applied;
+        }
+    }
+    QueryPerformanceCounter(&t_apply);
+
+    if (args.bench) {
+        attachConsole();
+        std::printf("\nLumos bench\n");
+        std::printf("  Process start to apply:  %8.2f ms\n", startup_ms);
+        std::printf("  Monitor enumeration:     %8.2f ms (%zu display%s)\n",
+                    elapsedMs(t_start, t_init, freq), gamma.getMonitorCount(),
+                    gamma.getMonitorCount() == 1 ? "" : "s");
+        std::printf("  Curve file load:         %8.2f ms\n", elapsedMs(t_init, t_load, freq));
+        std::printf("  Apply:                   %8.2f ms (%zu display%s)\n",
+                    elapsedMs(t_load, t_apply, freq), applied, applied == 1 ? "" : "s");
+        std::printf("  Total:                   %8.2f ms\n",
+                    startup_ms + elapsedMs(t_start, t_apply, freq));
+        std::printf("  Result:                  %s\n\n", success ? "ok" : "failed");
+    }
+
+    // Don't restore on exit for CLI mode (no originals were captured)
+    return success ? 0 : 1;
+}
+
+int Cli::runExit()
+{
+    HWND instance = platform::findRunningInstance();
+    if (!instance) {
+        return 0;  // Nothing running in this session
+    }
+
+    CliArgs args;
+    args.action = CliAction::ExitInstance;
+    auto reply = platform::sendCommand(instance, toCommand(args), kForwardTimeoutMs);
+    if (!reply) {
+        printError("The running instance did not respond");
+        return 1;
+    }
+    return 0;
+}
+
+void Cli::printHelp()
+{
+    attachConsole();
 
     std::printf("\nLumos - Monitor Gamma Adjustment Utility\n\n");
     std::printf("Usage:\n");
     std::printf("  lumos              Open the GUI\n");
     std::printf("  lumos <value>      Set gamma (0.1-9.0) and exit\n");
+    std::printf("  lumos [options]    Apply a curve and exit\n");
+    std::printf("  lumos --agent      Run headless: apply the saved curve and take commands\n");
+    std::printf("  lumos --exit       Stop the instance running in this session\n");
     std::printf("  lumos --help       Show this help message\n");
     std::printf("  lumos --version    Show version information\n");
     std::printf("\n");
+    std::printf("Apply options:\n");
+    std::printf("  --curve <name>     linear, power, shadowlift, softcontrast, cinema, custom\n");
+    std::printf("  --strength <value> Curve strength (0.1-9.0, default 1.0)\n");
+    std::printf("  --file <path>      Custom .curve file (implies --curve custom)\n");
+    std::printf("  --monitor <list>   Displays to change: 1-based numbers (\"1,3\") or \"primary\"\n");
+    std::printf("  --bench            Print startup and apply timings\n");
+    std::printf("\n");
     std::printf("Hotkeys (when running):\n");
     std::printf("  Ctrl+Alt+Up        Increase gamma by 0.1\n");
     std::printf("  Ctrl+Alt+Down      Decrease gamma by 0.1\n");
@@ -121,19 +474,25 @@ void Cli::printHelp()
     std::printf("Examples:\n");
     std::printf("  lumos 1.2          Set gamma to 1.2\n");
     std::printf("  lumos 0.8          Set gamma to 0.8\n");
+    std::printf("  lumos --curve cinema --monitor 2\n");
+    std::printf("  lumos --file night.curve --monitor primary --bench\n");
     std::printf("\n");
 }
 
 void Cli::printVersion()
 {
-    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
-        FILE* fp = nullptr;
-        freopen_s(&fp, "CONOUT$", "w", stdout);
-    }
+    attachConsole();
 
     std::printf("\nLumos v0.2.0\n");
     std::printf("Copyright (C) 2026 Ian Dirk Armstrong\n");
     std::printf("License: GPL v2\n\n");
 }
 
+void Cli::printError(const std::string& message)
+{
+    attachConsole();
+    std::fprintf(stderr, "lumos: %s\n", message.c_str());
+    std::fprintf(stderr, "Run 'lumos --help' for usage.\n");
+}
+
 } // namespace lumos
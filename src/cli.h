@@ -6,19 +6,30 @@
 
 #include <optional>
 #include <string>
+#include <vector>
+#include "platform/win32/gamma.h"
 
 namespace lumos {
 
 enum class CliAction {
     ShowGui,        // No args or invalid args: launch GUI
-    SetGamma,       // Numeric arg: set gamma and exit
+    SetGamma,       // Numeric arg or apply options: apply and exit
     ShowHelp,       // --help: show usage
-    ShowVersion     // --version: show version
+    ShowVersion,    // --version: show version
+    RunAgent,       // --agent: headless session agent (no window or renderer)
+    ExitInstance,   // --exit: ask the running instance to quit
+    InvalidArgs     // Apply options with a bad value: report and exit
 };
 
 struct CliArgs {
     CliAction action = CliAction::ShowGui;
-    double gamma_value = 1.0;
+    double gamma_value = 1.0;                                 // Strength
+    platform::ToneCurve curve = platform::ToneCurve::Power;   // --curve
+    std::string curve_file;                                   // --file (implies Custom)
+    std::vector<size_t> monitors;                             // --monitor, 0-based; empty = all
+    bool primary_monitor = false;                             // --monitor primary
+    bool bench = false;                                       // --bench: report timings
+    std::string error;                                        // Set for InvalidArgs
 };
 
 class Cli {
@@ -27,14 +38,32 @@ public:
     static CliArgs parse(int argc, char* argv[]);
     static CliArgs parse(const wchar_t* cmdLine);
 
+    // Apply the parsed settings and exit code for WinMain. Forwarded to the
+    // running GUI instance if there is one; otherwise applied here,
+    // windowless: no COM, no D3D, and original ramps aren't captured.
+    static int runApply(const CliArgs& args);
+
+    // Forward --exit to the running instance (exit code for WinMain)
+    static int runExit();
+
+    // Encode/decode parsed arguments for the single-instance channel
+    // (ShowGui, SetGamma and ExitInstance only)
+    static std::string toCommand(const CliArgs& args);
+    static std::optional<CliArgs> fromCommand(const std::string& command);
+
     // Print help to stdout (requires console)
     static void printHelp();
 
     // Print version to stdout (requires console)
     static void printVersion();
 
+    // Print a usage error to stderr (requires console)
+    static void printError(const std::string& message);
+
 private:
     static std::optional<double> parseGammaValue(const std::string& str);
+    static std::optional<platform::ToneCurve> parseToneCurve(const std::string& str);
+    static bool parseMonitorList(const std::string& str, CliArgs& args);
 };
 
 } // namespace lumos
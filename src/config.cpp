@@ -155,6 +155,59 @@ bool HotkeyUtils::stringToBinding(const std::string& str, HotkeyBinding& out)
     return true;
 }
 
+// Parse curve points: "x1:y1,x2:y2,x3:y3,...". Invalid points are
+// skipped; fewer than two valid ones give the linear default.
+static std::vector<platform::CurvePoint> parseCurvePoints(const std::string& curve_data)
+{
+    std::vector<platform::CurvePoint> points;
+
+    size_t pos = 0;
+    while (pos < curve_data.size()) {
+        // Find next comma (or end of string)
+        size_t comma_pos = curve_data.find(',', pos);
+        if (comma_pos == std::string::npos) {
+            comma_pos = curve_data.size();
+        }
+
+        // Extract point pair "x:y"
+        std::string pair = curve_data.substr(pos, comma_pos - pos);
+        size_t colon_pos = pair.find(':');
+
+        if (colon_pos != std::string::npos) {
+            try {
+                double x = std::stod(pair.substr(0, colon_pos));
+                double y = std::stod(pair.substr(colon_pos + 1));
+
+                // Validate range
+                if (x >= 0.0 && x <= 1.0 && y >= 0.0 && y <= 1.0) {
+                    points.push_back({x, y});
+                }
+            } catch (...) {
+                // Skip invalid points
+            }
+        }
+
+        pos = comma_pos + 1;
+    }
+
+    // Ensure at least 2 points, otherwise reset to default linear
+    if (points.size() < 2) {
+        points = {{0.0, 0.0}, {1.0, 1.0}};
+    }
+
+    // Sort by x-coordinate
+    std::sort(points.begin(), points.end());
+    return points;
+}
+
+static void writeCurvePoints(std::ostream& file, const std::vector<platform::CurvePoint>& points)
+{
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (i > 0) file << ",";
+        file << points[i].x << ":" << points[i].y;
+    }
+}
+
 std::filesystem::path Config::getConfigDir()
 {
     wchar_t* path = nullptr;
@@ -192,50 +245,138 @@ bool Config::load()
                 last_gamma = 1.0;
             }
         }
+        else if (line.starts_with("WhitePoint=")) {
+            try {
+                white_point_k = std::clamp(std::stod(line.substr(11)),
+                                           platform::kMinWhitePointK, platform::kMaxWhitePointK);
+            } catch (...) {
+                white_point_k = platform::kNeutralWhitePointK;
+            }
+        }
+        else if (line.starts_with("TransitionMs=")) {
+            try {
+                transition_ms = std::clamp(std::stod(line.substr(13)), 0.0, 5000.0);
+            } catch (...) {
+                transition_ms = 250.0;
+            }
+        }
+        else if (line.starts_with("VerifyPolicy=")) {
+            std::string val = line.substr(13);
+            if (val == "Full") verify_policy = platform::VerifyPolicy::Full;
+            else if (val == "Trusted") verify_policy = platform::VerifyPolicy::Trusted;
+            else verify_policy = platform::VerifyPolicy::Sampled;
+        }
         else if (line.starts_with("TransferFunction=")) {
             transfer_function = line.substr(17);
         }
+        else if (line.starts_with("CustomSmooth=")) {
+            std::string val = line.substr(13);
+            custom_curve_smooth = (val == "1" || val == "true");
+        }
         else if (line.starts_with("Custom=")) {
-            // Parse custom curve points: "x1:y1,x2:y2,x3:y3,..."
-            custom_curve_points.clear();
-            std::string curve_data = line.substr(7);
-
-            size_t pos = 0;
-            while (pos < curve_data.size()) {
-                // Find next comma (or end of string)
-                size_t comma_pos = curve_data.find(',', pos);
-                if (comma_pos == std::string::npos) {
-                    comma_pos = curve_data.size();
-                }
-
-                // Extract point pair "x:y"
-                std::string pair = curve_data.substr(pos, comma_pos - pos);
-                size_t colon_pos = pair.find(':');
-
-                if (colon_pos != std::string::npos) {
-                    try {
-                        double x = std::stod(pair.substr(0, colon_pos));
-                        double y = std::stod(pair.substr(colon_pos + 1));
-
-                        // Validate range
-                        if (x >= 0.0 && x <= 1.0 && y >= 0.0 && y <= 1.0) {
-                            custom_curve_points.push_back({x, y});
-                        }
-                    } catch (...) {
-                        // Skip invalid points
+            custom_curve_points = parseCurvePoints(line.substr(7));
+        }
+        // Auto gamma
+        else if (line.starts_with("AutoEnabled=")) {
+            std::string val = line.substr(12);
+            auto_gamma.enabled = (val == "1" || val == "true");
+        }
+        else if (line.starts_with("AutoTarget=")) {
+            try {
+                auto_gamma.target = std::clamp(std::stod(line.substr(11)), 0.05, 0.95);
+            } catch (...) {
+                auto_gamma.target = 0.45;
+            }
+        }
+        else if (line.starts_with("AutoAmount=")) {
+            try {
+                auto_gamma.amount = std::clamp(std::stod(line.substr(11)), 0.0, 1.0);
+            } catch (...) {
+                auto_gamma.amount = 0.5;
+            }
+        }
+        else if (line.starts_with("AutoMaxBoost=")) {
+            try {
+                auto_gamma.max_boost = std::clamp(std::stod(line.substr(13)), 1.0, 3.0);
+            } catch (...) {
+                auto_gamma.max_boost = 1.5;
+            }
+        }
+        // Schedule
+        else if (line.starts_with("ScheduleEnabled=")) {
+            std::string val = line.substr(16);
+            schedule.enabled = (val == "1" || val == "true");
+        }
+        else if (line.starts_with("Latitude=")) {
+            try {
+                schedule.latitude = std::clamp(std::stod(line.substr(9)), -90.0, 90.0);
+            } catch (...) {
+                schedule.latitude = 0.0;
+            }
+        }
+        else if (line.starts_with("Longitude=")) {
+            try {
+                schedule.longitude = std::clamp(std::stod(line.substr(10)), -180.0, 180.0);
+            } catch (...) {
+                schedule.longitude = 0.0;
+            }
+        }
+        else if (line.starts_with("Event=")) {
+            // "<time>|<curve>|<strength>|<fade ms>"
+            ScheduleEntry entry;
+            if (parseScheduleEntry(line.substr(6), entry)) {
+                schedule.entries.push_back(entry);
+            }
+        }
+        else if (line.starts_with("Scale=")) {
+            // "<curve>|<scale>|<monitor id>" (id last, it may contain anything)
+            std::string entry = line.substr(6);
+            size_t first = entry.find('|');
+            size_t second = (first == std::string::npos) ? first : entry.find('|', first + 1);
+            if (second != std::string::npos) {
+                try {
+                    SafeScaleEntry scale_entry;
+                    scale_entry.curve = entry.substr(0, first);
+                    scale_entry.scale = std::stod(entry.substr(first + 1, second - first - 1));
+                    scale_entry.monitor_id = entry.substr(second + 1);
+                    if (scale_entry.scale > 0.0 && scale_entry.scale <= 1.0 &&
+                        !scale_entry.monitor_id.empty()) {
+                        safe_scales.push_back(scale_entry);
                     }
+                } catch (...) {
+                    // Skip invalid entries
                 }
-
-                pos = comma_pos + 1;
             }
-
-            // Ensure at least 2 points, otherwise reset to default linear
-            if (custom_curve_points.size() < 2) {
-                custom_curve_points = {{0.0, 0.0}, {1.0, 1.0}};
+        }
+        else if (line.starts_with("Profile=")) {
+            // "<curve>|<strength>|<smooth>|<points>|<monitor id>" (id last)
+            std::string entry = line.substr(8);
+            size_t fields[4];
+            size_t pos = 0;
+            bool complete = true;
+            for (size_t& field : fields) {
+                field = entry.find('|', pos);
+                if (field == std::string::npos) { complete = false; break; }
+                pos = field + 1;
+            }
+            if (complete) {
+                try {
+                    DisplayProfileEntry profile;
+                    profile.curve = entry.substr(0, fields[0]);
+                    profile.strength = std::clamp(
+                        std::stod(entry.substr(fields[0] + 1, fields[1] - fields[0] - 1)), 0.1, 9.0);
+                    std::string smooth = entry.substr(fields[1] + 1, fields[2] - fields[1] - 1);
+                    profile.custom_curve_smooth = (smooth == "1" || smooth == "true");
+                    profile.custom_curve_points =
+                        parseCurvePoints(entry.substr(fields[2] + 1, fields[3] - fields[2] - 1));
+                    profile.monitor_id = entry.substr(fields[3] + 1);
+                    if (!profile.monitor_id.empty()) {
+                        profiles.push_back(profile);
+                    }
+                } catch (...) {
+                    // Skip invalid entries
+                }
             }
-
-            // Sort by x-coordinate
-            std::sort(custom_curve_points.begin(), custom_curve_points.end());
         }
         // Hotkey bindings
         else if (line.starts_with("Increase=")) {
@@ -264,54 +405,170 @@ bool Config::load()
     return true;
 }
 
-bool Config::save()
+std::string Config::serializeSection(ConfigSection section) const
 {
-    auto config_dir = getConfigDir();
-    if (config_dir.empty()) return false;
+    std::ostringstream file;
+    switch (section) {
+    case ConfigSection::Gamma:
+        file << "[Gamma]\n";
+        file << "LastValue=" << last_gamma << "\n";
+        file << "TransferFunction=" << transfer_function << "\n";
+        file << "WhitePoint=" << white_point_k << "\n";
+        file << "TransitionMs=" << transition_ms << "\n";
+        file << "VerifyPolicy="
+             << (verify_policy == platform::VerifyPolicy::Full ? "Full"
+                 : verify_policy == platform::VerifyPolicy::Trusted ? "Trusted" : "Sampled")
+             << "\n";
+        break;
+
+    case ConfigSection::AutoGamma:
+        file << "[AutoGamma]\n";
+        file << "AutoEnabled=" << (auto_gamma.enabled ? "1" : "0") << "\n";
+        file << "AutoTarget=" << auto_gamma.target << "\n";
+        file << "AutoAmount=" << auto_gamma.amount << "\n";
+        file << "AutoMaxBoost=" << auto_gamma.max_boost << "\n";
+        break;
+
+    case ConfigSection::Schedule:
+        file << "[Schedule]\n";
+        file << "# Event=<HH:MM | sunrise[+-min] | sunset[+-min]>|<curve>|<strength>|<fade ms>[|<kelvin>]\n";
+        file << "ScheduleEnabled=" << (schedule.enabled ? "1" : "0") << "\n";
+        file << "Latitude=" << schedule.latitude << "\n";
+        file << "Longitude=" << schedule.longitude << "\n";
+        for (const auto& entry : schedule.entries) {
+            file << "Event=" << formatScheduleEntry(entry) << "\n";
+        }
+        break;
 
-    std::filesystem::create_directories(config_dir);
+    case ConfigSection::Curves:
+        file << "[Curves]\n";
 
-    auto config_path = getConfigPath();
-    std::ofstream file(config_path);
-    if (!file.is_open()) return false;
-
-    file << "[Gamma]\n";
-    file << "LastValue=" << last_gamma << "\n";
-    file << "TransferFunction=" << transfer_function << "\n";
-    file << "\n";
-    file << "[Curves]\n";
+        // Save custom curve points
+        if (!custom_curve_points.empty()) {
+            file << "Custom=";
+            writeCurvePoints(file, custom_curve_points);
+            file << "\n";
+        }
+        file << "CustomSmooth=" << (custom_curve_smooth ? "1" : "0") << "\n";
+        break;
+
+    case ConfigSection::Profiles:
+        file << "[Profiles]\n";
+        file << "# Profile=<curve>|<strength>|<smooth>|<x:y,...>|<monitor id>\n";
+        for (const auto& profile : profiles) {
+            file << "Profile=" << profile.curve << "|" << profile.strength << "|"
+                 << (profile.custom_curve_smooth ? "1" : "0") << "|";
+            writeCurvePoints(file, profile.custom_curve_points);
+            file << "|" << profile.monitor_id << "\n";
+        }
+        break;
 
-    // Save custom curve points
-    if (!custom_curve_points.empty()) {
-        file << "Custom=";
-        for (size_t i = 0; i < custom_curve_points.size(); ++i) {
-            if (i > 0) file << ",";
-            file << custom_curve_points[i].x << ":" << custom_curve_points[i].y;
+    case ConfigSection::SafeScale:
+        file << "[SafeScale]\n";
+        for (const auto& entry : safe_scales) {
+            file << "Scale=" << entry.curve << "|" << entry.scale << "|" << entry.monitor_id << "\n";
         }
-        file << "\n";
+        break;
+
+    case ConfigSection::Hotkeys:
+        file << "[Hotkeys]\n";
+        file << "Increase=" << HotkeyUtils::bindingToString(hotkey_increase) << "\n";
+        file << "Decrease=" << HotkeyUtils::bindingToString(hotkey_decrease) << "\n";
+        file << "Reset=" << HotkeyUtils::bindingToString(hotkey_reset) << "\n";
+        file << "Toggle=" << HotkeyUtils::bindingToString(hotkey_toggle) << "\n";
+        break;
+
+    case ConfigSection::Window:
+        file << "[Window]\n";
+        file << "MinimizeToTrayOnClose=" << (minimize_to_tray_on_close ? "1" : "0") << "\n";
+        file << "AlwaysOnTop=" << (always_on_top ? "1" : "0") << "\n";
+        break;
+
+    case ConfigSection::Count:
+        break;
     }
+    return file.str();
+}
 
-    file << "\n";
-    file << "[Hotkeys]\n";
-    file << "Increase=" << HotkeyUtils::bindingToString(hotkey_increase) << "\n";
-    file << "Decrease=" << HotkeyUtils::bindingToString(hotkey_decrease) << "\n";
-    file << "Reset=" << HotkeyUtils::bindingToString(hotkey_reset) << "\n";
-    file << "Toggle=" << HotkeyUtils::bindingToString(hotkey_toggle) << "\n";
+std::string Config::joinSections(const std::array<std::string, kConfigSectionCount>& sections)
+{
+    std::string text;
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (i > 0) text += "\n";
+        text += sections[i];
+    }
+    return text;
+}
 
-    file << "\n";
-    file << "[Window]\n";
-    file << "MinimizeToTrayOnClose=" << (minimize_to_tray_on_close ? "1" : "0") << "\n";
-    file << "AlwaysOnTop=" << (always_on_top ? "1" : "0") << "\n";
+bool Config::save()
+{
+    std::array<std::string, kConfigSectionCount> sections;
+    for (size_t i = 0; i < kConfigSectionCount; ++i) {
+        sections[i] = serializeSection(static_cast<ConfigSection>(i));
+    }
+    return writeFileAtomic(getConfigPath(), joinSections(sections));
+}
 
+bool Config::writeFileAtomic(const std::filesystem::path& path, const std::string& text)
+{
+    if (path.empty()) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::filesystem::path temp_path = path;
+    temp_path += L".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        file.flush();
+        if (!file.good()) {
+            file.close();
+            DeleteFileW(temp_path.c_str());
+            return false;
+        }
+    }
+
+    // The old file stays intact until the new one is complete. ReplaceFileW
+    // needs an existing target; the first save just moves the file in.
+    BOOL replaced = std::filesystem::exists(path, ec)
+        ? ReplaceFileW(path.c_str(), temp_path.c_str(), nullptr,
+                       REPLACEFILE_IGNORE_MERGE_ERRORS, nullptr, nullptr)
+        : MoveFileExW(temp_path.c_str(), path.c_str(), MOVEFILE_WRITE_THROUGH);
+    if (!replaced) {
+        DeleteFileW(temp_path.c_str());
+        return false;
+    }
     return true;
 }
 
+std::string wideToUtf8(const std::wstring& str)
+{
+    if (str.empty()) return {};
+    int size = WideCharToMultiByte(CP_UTF8, 0, str.c_str(), -1, nullptr, 0, nullptr, nullptr);
+    if (size <= 1) return {};
+    std::string result(size - 1, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, str.c_str(), -1, result.data(), size, nullptr, nullptr);
+    return result;
+}
+
+std::wstring utf8ToWide(const std::string& str)
+{
+    if (str.empty()) return {};
+    int size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, nullptr, 0);
+    if (size <= 1) return {};
+    std::wstring result(size - 1, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, result.data(), size);
+    return result;
+}
+
 // CurveIO namespace implementation
 namespace CurveIO {
 
 bool saveCurve(const std::string& path, const std::vector<platform::CurvePoint>& points)
 {
-    std::ofstream file(path);
+    std::ofstream file(std::filesystem::path(utf8ToWide(path)));
     if (!file.is_open()) return false;
 
     file << "# Lumos Curve File\n";
@@ -326,7 +583,7 @@ std::vector<platform::CurvePoint> loadCurve(const std::string& path)
 {
     std::vector<platform::CurvePoint> points;
 
-    std::ifstream file(path);
+    std::ifstream file(std::filesystem::path(utf8ToWide(path)));
     if (!file.is_open()) return points;
 
     std::string line;
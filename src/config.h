@@ -4,10 +4,13 @@
 
 #pragma once
 
+#include <array>
 #include <string>
 #include <vector>
 #include <filesystem>
 #include "platform/win32/gamma.h"
+#include "auto_gamma.h"
+#include "schedule.h"
 
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
@@ -51,6 +54,37 @@ namespace HotkeyUtils {
     const std::vector<KeyInfo>& getBindableKeys();
 }
 
+// Learned adaptive ramp scale for one monitor and curve family
+struct SafeScaleEntry {
+    std::string monitor_id;  // Monitor device interface path (UTF-8)
+    std::string curve;       // Tone curve name, as in TransferFunction
+    double scale = 1.0;
+};
+
+// A display's own curve, used instead of the app-wide one
+struct DisplayProfileEntry {
+    std::string monitor_id;  // Monitor device interface path (UTF-8)
+    std::string curve = "Power";  // Tone curve name, as in TransferFunction
+    double strength = 1.0;
+    std::vector<platform::CurvePoint> custom_curve_points;
+    bool custom_curve_smooth = false;
+};
+
+// INI sections, in file order. Each serializes independently, so a
+// background save only rebuilds the ones that changed.
+enum class ConfigSection {
+    Gamma,
+    AutoGamma,
+    Schedule,
+    Curves,
+    Profiles,
+    SafeScale,
+    Hotkeys,
+    Window,
+    Count
+};
+constexpr size_t kConfigSectionCount = static_cast<size_t>(ConfigSection::Count);
+
 class Config {
 public:
     Config() = default;
@@ -58,13 +92,39 @@ public:
     // Load config from file (creates default if missing)
     bool load();
 
-    // Save config to file
+    // Save config to file (synchronously, all sections)
     bool save();
 
+    // One section's text, header line included
+    std::string serializeSection(ConfigSection section) const;
+
+    // The whole file from its section texts
+    static std::string joinSections(const std::array<std::string, kConfigSectionCount>& sections);
+
+    // Write through a temp file and ReplaceFileW, so a crash mid-write
+    // leaves the previous file intact
+    static bool writeFileAtomic(const std::filesystem::path& path, const std::string& text);
+
     // Settings
     double last_gamma = 1.0;
     std::string transfer_function = "Power";
     std::vector<platform::CurvePoint> custom_curve_points;
+    bool custom_curve_smooth = false;  // Monotone cubic instead of straight segments
+    double white_point_k = 6500.0;  // Color temperature applied with the curve
+    double transition_ms = 250.0;  // Fade duration for toggle/reset/hotkeys (0 = instant)
+    platform::VerifyPolicy verify_policy = platform::VerifyPolicy::Sampled;  // Ramp readback checks
+
+    // Histogram-driven strength adjustment
+    AutoGammaSettings auto_gamma;
+
+    // Automatic curve changes by time of day
+    ScheduleSettings schedule;
+
+    // Per-monitor, per-curve ramp acceptance learned by the adaptive apply
+    std::vector<SafeScaleEntry> safe_scales;
+
+    // Displays with their own curve (the rest use the settings above)
+    std::vector<DisplayProfileEntry> profiles;
 
     // Hotkey bindings
     HotkeyBinding hotkey_increase = { MOD_CONTROL | MOD_ALT, VK_UP };
@@ -76,12 +136,20 @@ public:
     bool minimize_to_tray_on_close = true;
     bool always_on_top = false;
 
-private:
+    // %APPDATA%\Lumos (also where diagnostics are written)
     std::filesystem::path getConfigDir();
+
+    // %APPDATA%\Lumos\lumos.ini
     std::filesystem::path getConfigPath();
 };
 
 // Curve file I/O utilities
+// Strings travel as UTF-8 (INI, argv, file dialogs, the command channel);
+// convert at the Win32 and filesystem boundary, never through the ANSI
+// code page
+std::string wideToUtf8(const std::wstring& str);
+std::wstring utf8ToWide(const std::string& str);
+
 namespace CurveIO {
     // Save curve points to a .curve file
     bool saveCurve(const std::string& path, const std::vector<platform::CurvePoint>& points);
@@ -0,0 +1,157 @@
+// Lumos - Background config persistence
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#include "config_writer.h"
+#include "config.h"
+#include <algorithm>
+#include <utility>
+
+namespace lumos {
+
+ConfigWriter::~ConfigWriter()
+{
+    stop();
+}
+
+bool ConfigWriter::start(const std::filesystem::path& path, std::string written,
+                         const std::filesystem::path& library_path)
+{
+    if (running_) return true;
+
+    wake_event_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!wake_event_) return false;
+
+    path_ = path;
+    written_ = std::move(written);
+    library_path_ = library_path;
+    running_ = true;
+    writer_thread_ = std::thread(&ConfigWriter::writerThread, this);
+    return true;
+}
+
+void ConfigWriter::stop()
+{
+    running_ = false;
+    if (wake_event_) {
+        SetEvent(wake_event_);
+    }
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+    if (wake_event_) { CloseHandle(wake_event_); wake_event_ = nullptr; }
+}
+
+void ConfigWriter::post(std::string text)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ = std::move(text);
+        has_pending_ = true;
+    }
+    if (wake_event_) {
+        SetEvent(wake_event_);
+    }
+}
+
+void ConfigWriter::postCurveLibrary(std::vector<LibraryCurve> curves,
+                                    std::vector<platform::AcceptedRampRecord> accepted)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_curves_ = std::move(curves);
+        pending_accepted_ = std::move(accepted);
+        has_pending_library_ = true;
+    }
+    if (wake_event_) {
+        SetEvent(wake_event_);
+    }
+}
+
+void ConfigWriter::writerThread()
+{
+    while (running_) {
+        WaitForSingleObject(wake_event_, library_retry_ ? kLibraryRetryMs : INFINITE);
+
+        // Every post within the window restarts it
+        while (running_ && WaitForSingleObject(wake_event_, kDebounceMs) == WAIT_OBJECT_0) {
+        }
+        writePending();
+        writePendingLibrary();
+    }
+
+    // Exit: whatever arrived last still has to reach the disk
+    writePending();
+    writePendingLibrary();
+}
+
+void ConfigWriter::writePending()
+{
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!has_pending_) return;
+        text = std::move(pending_);
+        has_pending_ = false;
+    }
+
+    if (text == written_) return;
+    if (Config::writeFileAtomic(path_, text)) {
+        written_ = std::move(text);
+        write_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ConfigWriter::writePendingLibrary()
+{
+    std::vector<LibraryCurve> curves;
+    std::vector<platform::AcceptedRampRecord> accepted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!has_pending_library_) return;
+        curves = std::move(pending_curves_);
+        accepted = std::move(pending_accepted_);
+        has_pending_library_ = false;
+    }
+
+    std::vector<platform::CurveLibraryCurve> records;
+    std::vector<platform::RampKey> curve_keys;
+    for (const auto& curve : curves) {
+        const std::vector<platform::CurvePoint>* custom =
+            (curve.curve == platform::ToneCurve::Custom) ? &curve.points : nullptr;
+        platform::RampKey key = platform::Gamma::makeRampKey(curve.curve, curve.strength, custom,
+                                                             curve.interpolation,
+                                                             curve.white_point_k);
+        if (std::find(curve_keys.begin(), curve_keys.end(), key) != curve_keys.end()) continue;
+        curve_keys.push_back(key);
+
+        platform::CurveLibraryCurve record;
+        record.key = key;
+        if (custom) record.points = curve.points;
+        record.ramp = platform::buildRamp(curve.curve, curve.strength, custom, curve.interpolation,
+                                          static_cast<double>(key.white_point_k));
+        records.push_back(std::move(record));
+    }
+
+    library_retry_ = false;
+    if (records == written_curves_ && accepted == written_accepted_) return;
+
+    if (Config::writeFileAtomic(library_path_,
+                                platform::CurveLibrary::serialize(records, accepted))) {
+        written_curves_ = std::move(records);
+        written_accepted_ = std::move(accepted);
+        return;
+    }
+
+    // Usually a sharing violation (another process has the library open).
+    // Try again shortly unless something newer has been posted meanwhile.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!has_pending_library_) {
+        pending_curves_ = std::move(curves);
+        pending_accepted_ = std::move(accepted);
+        has_pending_library_ = true;
+    }
+    library_retry_ = true;
+}
+
+} // namespace lumos
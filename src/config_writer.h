@@ -0,0 +1,107 @@
+// Lumos - Background config persistence
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "platform/win32/curve_library.h"
+#include "platform/win32/gamma.h"
+
+namespace lumos {
+
+// A curve to keep in the curve library. Its ramp is built on the writer
+// thread, not by whoever posts it.
+struct LibraryCurve {
+    platform::ToneCurve curve = platform::ToneCurve::Power;
+    double strength = 1.0;
+    std::vector<platform::CurvePoint> points;  // Custom only
+    platform::CurveInterpolation interpolation = platform::CurveInterpolation::Linear;
+    double white_point_k = platform::kNeutralWhitePointK;
+};
+
+// Writes the config file (and the curve library next to it) on its own
+// thread, so settings survive a crash without the UI ever waiting on the
+// disk.
+//
+// post() hands over the complete file text and returns at once. The thread
+// waits until posts have stopped for kDebounceMs (a slider drag posts every
+// frame), then writes the newest text with Config::writeFileAtomic. Text
+// identical to what is already on disk is not written again. The curve
+// library works the same way through postCurveLibrary(), and a library
+// write that fails (the file is shared with other processes) is retried.
+class ConfigWriter {
+public:
+    ConfigWriter() = default;
+    ~ConfigWriter();
+
+    ConfigWriter(const ConfigWriter&) = delete;
+    ConfigWriter& operator=(const ConfigWriter&) = delete;
+
+    // written is the text currently on disk (skipped if posted unchanged)
+    bool start(const std::filesystem::path& path, std::string written,
+               const std::filesystem::path& library_path);
+
+    // Write whatever is still pending right away, then stop the thread
+    void stop();
+
+    // Queue the full file text (UI thread)
+    void post(std::string text);
+
+    // Queue the curve library contents (UI thread): the curves in use and
+    // every monitor's accepted ramps
+    void postCurveLibrary(std::vector<LibraryCurve> curves,
+                          std::vector<platform::AcceptedRampRecord> accepted);
+
+    // Completed writes (diagnostics)
+    uint64_t getWriteCount() const { return write_count_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr DWORD kDebounceMs = 1000;
+    static constexpr DWORD kLibraryRetryMs = 5000;  // After a failed library write
+
+    void writerThread();
+    void writePending();
+    void writePendingLibrary();
+
+    std::filesystem::path path_;
+    std::mutex mutex_;
+    std::string pending_;
+    bool has_pending_ = false;
+    std::string written_;  // Writer thread only
+
+    std::filesystem::path library_path_;
+    std::vector<LibraryCurve> pending_curves_;
+    std::vector<platform::AcceptedRampRecord> pending_accepted_;
+    bool has_pending_library_ = false;
+
+    // Contents of the library on disk (writer thread only), to skip
+    // rewrites. Ramps are compared too: an accepted ramp can change under
+    // the same key (envelope refit, re-probe) and nearby Power strengths
+    // share a quantized key.
+    std::vector<platform::CurveLibraryCurve> written_curves_;
+    std::vector<platform::AcceptedRampRecord> written_accepted_;
+    bool library_retry_ = false;  // Writer thread only: a failed write is queued again
+
+    std::thread writer_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> write_count_{0};
+    HANDLE wake_event_ = nullptr;
+};
+
+} // namespace lumos
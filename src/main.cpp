@@ -12,6 +12,8 @@
 
 #include <windows.h>
 #include <objbase.h>
+#include <dbt.h>
+#include <wtsapi32.h>
 #include <d3d11.h>
 #include <dxgi.h>
 
@@ -22,6 +24,8 @@
 
 #include "app.h"
 #include "cli.h"
+#include "platform/win32/instance_channel.h"
+#include "platform/win32/perf_trace.h"
 #include "ui/main_window.h"
 #include "ui/theme.h"
 #include "../resources/resource.h"
@@ -32,6 +36,14 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 // Custom window messages
 constexpr UINT WM_TRAYICON = WM_USER + 1;
 
+// Frames rendered after input so ImGui can settle hover/active state
+constexpr int kRedrawFramesAfterInput = 3;
+
+// Longest the visible window sleeps without a redraw (keeps the status bar
+// counters fresh; shorter while a text field shows a blinking cursor)
+constexpr DWORD kVisibleIdleMs = 1000;
+constexpr DWORD kTextInputIdleMs = 250;
+
 // Globals for DX11
 static ID3D11Device* g_pd3dDevice = nullptr;
 static ID3D11DeviceContext* g_pd3dDeviceContext = nullptr;
@@ -54,6 +66,8 @@ LONG WINAPI CrashHandler(EXCEPTION_POINTERS* exceptionInfo)
 }
 
 // Forward declarations
+bool CreateRenderer(HWND hWnd, lumos::ui::MainWindow& main_window);
+void DestroyRenderer(lumos::ui::MainWindow& main_window);
 bool CreateDeviceD3D(HWND hWnd);
 void CleanupDeviceD3D();
 void CreateRenderTarget();
@@ -70,9 +84,6 @@ int WINAPI WinMain(
     (void)lpCmdLine;
     (void)nCmdShow;
 
-    // Initialize COM (required for native file dialogs)
-    CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
-
     // Set up crash handler
     SetUnhandledExceptionFilter(CrashHandler);
 
@@ -88,18 +99,41 @@ int WINAPI WinMain(
         lumos::Cli::printVersion();
         return 0;
 
+    case lumos::CliAction::InvalidArgs:
+        lumos::Cli::printError(cli_args.error);
+        return 2;
+
     case lumos::CliAction::SetGamma:
-        {
-            lumos::platform::Gamma gamma;
-            gamma.initialize();
-            gamma.applyAll(cli_args.gamma_value);
-            // Don't restore on exit for CLI mode
-        }
-        return 0;
+        // Windowless fast path: returns before COM, D3D or any delay-loaded DLL
+        return lumos::Cli::runApply(cli_args);
+
+    case lumos::CliAction::ExitInstance:
+        return lumos::Cli::runExit();
 
+    case lumos::CliAction::RunAgent:
     case lumos::CliAction::ShowGui:
     default:
-        break; // Continue to GUI
+        break; // Continue to GUI (or the headless agent)
+    }
+
+    // Headless per-session agent: the same App and message loop, but the
+    // window is never shown, so no COM, D3D or ImGui state is ever created
+    const bool agent = (cli_args.action == lumos::CliAction::RunAgent);
+
+    // Single instance (per session): a second GUI launch brings up the
+    // running one; a second agent just leaves
+    lumos::platform::InstanceLock instance_lock;
+    if (!instance_lock.acquire()) {
+        HWND running = lumos::platform::findRunningInstance();
+        if (running && !agent) {
+            lumos::platform::sendCommand(running, lumos::Cli::toCommand(cli_args), 1000);
+        }
+        return 0;
+    }
+
+    // Initialize COM (required for native file dialogs)
+    if (!agent) {
+        CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
     }
 
     // Register window class
@@ -108,7 +142,7 @@ int WINAPI WinMain(
     wc.style = CS_CLASSDC;
     wc.lpfnWndProc = WndProc;
     wc.hInstance = hInstance;
-    wc.lpszClassName = L"LumosWindowClass";
+    wc.lpszClassName = lumos::platform::kWindowClassName;
     wc.hIcon = LoadIconW(hInstance, MAKEINTRESOURCEW(IDI_LUMOS));
     wc.hIconSm = LoadIconW(hInstance, MAKEINTRESOURCEW(IDI_LUMOS));
     RegisterClassExW(&wc);
@@ -123,48 +157,45 @@ int WINAPI WinMain(
         700, 550,  // Larger window for custom curve editor
         nullptr, nullptr, hInstance, nullptr);
 
-    if (!CreateDeviceD3D(hwnd))
-    {
-        CleanupDeviceD3D();
-        UnregisterClassW(wc.lpszClassName, hInstance);
-        return 1;
+    // UI (renderer state is created/destroyed with window visibility)
+    lumos::ui::MainWindow main_window;
+    bool renderer_active = false;
+    if (!agent) {
+        if (!CreateRenderer(hwnd, main_window))
+        {
+            DestroyWindow(hwnd);
+            UnregisterClassW(wc.lpszClassName, hInstance);
+            return 1;
+        }
+        renderer_active = true;
     }
 
-    // Setup ImGui
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImPlot::CreateContext();
-    ImGuiIO& io = ImGui::GetIO();
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-    io.IniFilename = nullptr; // Disable imgui.ini
-
-    // Apply VS Code-style theme
-    lumos::ui::ApplyVSCodeTheme();
-
-    ImGui_ImplWin32_Init(hwnd);
-    ImGui_ImplDX11_Init(g_pd3dDevice, g_pd3dDeviceContext);
-
     // Initialize app
     lumos::App app;
     g_app = &app;
-    app.initialize(hwnd, WM_TRAYICON);
+    app.initialize(hwnd, WM_TRAYICON, agent ? lumos::AppMode::Agent : lumos::AppMode::Window);
+
+    // Logon, lock and RDP connect/disconnect of this session
+    WTSRegisterSessionNotification(hwnd, NOTIFY_FOR_THIS_SESSION);
 
     // Enable crash safety
     g_crash_gamma = &app.getGammaRef();
 
-    // UI
-    lumos::ui::MainWindow main_window;
-    main_window.initIconTextures(g_pd3dDevice);
-
     // Connect app dialog callbacks to main window
     app.on_show_help = [&main_window]() { main_window.openHelp(); };
     app.on_show_about = [&main_window]() { main_window.openAbout(); };
 
-    // Show window
-    ShowWindow(hwnd, SW_SHOWDEFAULT);
-    UpdateWindow(hwnd);
+    // Show window (the agent's stays hidden: it only receives messages)
+    if (!agent) {
+        ShowWindow(hwnd, SW_SHOWDEFAULT);
+        UpdateWindow(hwnd);
+    }
 
-    // Main loop
+    // Main loop. Renders only when something changed (input, a finished
+    // gamma apply, a new histogram sample) and otherwise sleeps in
+    // MsgWaitForMultipleObjectsEx, so a hidden window doesn't wake at all.
+    int redraw_frames = kRedrawFramesAfterInput;
+    uint64_t histogram_generation = 0;
     while (!app.shouldExit())
     {
         MSG msg;
@@ -175,50 +206,146 @@ int WINAPI WinMain(
             if (msg.message == WM_QUIT) {
                 app.requestExit();
             }
+            redraw_frames = kRedrawFramesAfterInput;
         }
 
         if (app.shouldExit())
             break;
 
-        // Skip rendering if window is hidden
-        if (!app.isWindowVisible()) {
-            Sleep(100); // Reduce CPU usage when hidden
-            continue;
+        // Pick up results from the gamma apply worker
+        app.update();
+
+        // Tray-lite: nothing graphical stays alive while hidden
+        bool visible = app.isWindowVisible();
+        if (!visible && renderer_active) {
+            DestroyRenderer(main_window);
+            renderer_active = false;
+        } else if (visible && !renderer_active) {
+            if (!CreateRenderer(hwnd, main_window)) {
+                app.requestExit();
+                break;
+            }
+            renderer_active = true;
+            redraw_frames = kRedrawFramesAfterInput;
+        }
+
+        if (visible && app.getHistogramGeneration() != histogram_generation) {
+            histogram_generation = app.getHistogramGeneration();
+            if (redraw_frames == 0) {
+                redraw_frames = 1;
+            }
         }
 
-        // Start ImGui frame
-        ImGui_ImplDX11_NewFrame();
-        ImGui_ImplWin32_NewFrame();
-        ImGui::NewFrame();
+        if (!visible || redraw_frames == 0) {
+            // Histogram samples only matter while they can be seen, or
+            // while auto gamma is acting on them
+            HANDLE handles[3];
+            DWORD handle_count = 0;
+            if (HANDLE completion = app.getGammaCompletionEvent()) {
+                handles[handle_count++] = completion;
+            }
+            if (HANDLE schedule_timer = app.getScheduleTimer()) {
+                handles[handle_count++] = schedule_timer;
+            }
+            if (HANDLE histogram_event = app.getHistogramUpdateEvent();
+                histogram_event && (visible || app.isAutoGammaEnabled())) {
+                handles[handle_count++] = histogram_event;
+            }
+
+            DWORD timeout = INFINITE;
+            if (visible) {
+                timeout = ImGui::GetIO().WantTextInput ? kTextInputIdleMs : kVisibleIdleMs;
+            }
+            MsgWaitForMultipleObjectsEx(handle_count, handles, timeout, QS_ALLINPUT,
+                                        MWMO_INPUTAVAILABLE);
+            app.noteWakeup();
 
-        // Render UI
-        main_window.render(app);
+            // Messages are handled at the top of the loop; anything else
+            // (apply finished, new sample, timeout) is worth one frame
+            redraw_frames = 1;
+            continue;
+        }
+        --redraw_frames;
 
-        // Render
-        ImGui::Render();
-        const float clear_color[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
-        g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
-        g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color);
-        ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+        {
+            lumos::platform::PerfScope frame_timer(lumos::platform::PerfStage::UiFrame);
+
+            // Start ImGui frame
+            ImGui_ImplDX11_NewFrame();
+            ImGui_ImplWin32_NewFrame();
+            ImGui::NewFrame();
+
+            // Render UI
+            main_window.render(app);
+
+            // Render
+            ImGui::Render();
+            const float clear_color[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
+            g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
+            g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color);
+            ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+        }
 
+        lumos::platform::PerfScope present_timer(lumos::platform::PerfStage::Present);
         g_pSwapChain->Present(1, 0); // VSync
     }
 
     // Shutdown
+    WTSUnRegisterSessionNotification(hwnd);
     app.shutdown();
     g_app = nullptr;
 
+    if (renderer_active) {
+        DestroyRenderer(main_window);
+    }
+    DestroyWindow(hwnd);
+    UnregisterClassW(wc.lpszClassName, hInstance);
+
+    if (!agent) {
+        CoUninitialize();
+    }
+    return 0;
+}
+
+// D3D11 device/swap chain, ImGui + ImPlot contexts (and with them the font
+// atlas) and the status bar icons. Torn down while tray-resident and rebuilt
+// on show; device creation dominates and is well under 100 ms.
+bool CreateRenderer(HWND hWnd, lumos::ui::MainWindow& main_window)
+{
+    if (!CreateDeviceD3D(hWnd))
+    {
+        CleanupDeviceD3D();
+        return false;
+    }
+
+    // Setup ImGui
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImPlot::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+    io.IniFilename = nullptr; // Disable imgui.ini
+
+    // Apply VS Code-style theme
+    lumos::ui::ApplyVSCodeTheme();
+
+    ImGui_ImplWin32_Init(hWnd);
+    ImGui_ImplDX11_Init(g_pd3dDevice, g_pd3dDeviceContext);
+
+    main_window.initIconTextures(g_pd3dDevice);
+    return true;
+}
+
+void DestroyRenderer(lumos::ui::MainWindow& main_window)
+{
+    main_window.releaseIconTextures();
+
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
     ImPlot::DestroyContext();
     ImGui::DestroyContext();
 
     CleanupDeviceD3D();
-    DestroyWindow(hwnd);
-    UnregisterClassW(wc.lpszClassName, hInstance);
-
-    CoUninitialize();
-    return 0;
 }
 
 bool CreateDeviceD3D(HWND hWnd)
@@ -278,7 +405,8 @@ void CleanupRenderTarget()
 
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
-    if (ImGui_ImplWin32_WndProcHandler(hWnd, msg, wParam, lParam))
+    // No ImGui context while tray-resident (renderer torn down)
+    if (ImGui::GetCurrentContext() && ImGui_ImplWin32_WndProcHandler(hWnd, msg, wParam, lParam))
         return true;
 
     switch (msg)
@@ -295,6 +423,44 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
         }
         return 0;
 
+    case WM_COPYDATA:
+        // Command forwarded from a CLI invocation or second launch
+        {
+            std::string payload;
+            if (g_app && lumos::platform::readCommand(lParam, payload)) {
+                bool accepted = g_app->handleRemoteCommand(payload);
+                return static_cast<LRESULT>(accepted ? lumos::platform::CommandReply::Accepted
+                                                     : lumos::platform::CommandReply::Rejected);
+            }
+        }
+        break;
+
+    case WM_DISPLAYCHANGE:
+        if (g_app) {
+            g_app->handleDisplayChange();
+        }
+        break;
+
+    case WM_WTSSESSION_CHANGE:
+        if (g_app) {
+            g_app->handleSessionChange(wParam);
+        }
+        return 0;
+
+    case WM_TIMECHANGE:
+        // Clock set or time zone changed: schedule times move
+        if (g_app) {
+            g_app->handleTimeChange();
+        }
+        break;
+
+    case WM_DEVICECHANGE:
+        // Monitor plugged/unplugged
+        if (g_app && wParam == DBT_DEVNODES_CHANGED) {
+            g_app->handleDisplayChange();
+        }
+        break;
+
     case WM_SIZE:
         if (g_pd3dDevice != nullptr && wParam != SIZE_MINIMIZED)
         {
@@ -323,8 +489,10 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
         break;
 
     case WM_CLOSE:
-        // Hide to tray instead of closing (if enabled and not exit requested)
-        if (g_app && !g_app->shouldExit() && g_app->getMinimizeToTrayOnClose()) {
+        // Hide to tray instead of closing (if enabled and not exit requested);
+        // the agent has no tray, so closing it always exits
+        if (g_app && !g_app->shouldExit() && !g_app->isAgent() &&
+            g_app->getMinimizeToTrayOnClose()) {
             g_app->hideWindow();
             return 0;
         }
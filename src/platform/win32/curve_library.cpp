@@ -0,0 +1,171 @@
+// Lumos - Binary curve library
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#include "curve_library.h"
+#include <cstring>
+
+namespace lumos::platform {
+
+namespace {
+
+constexpr size_t alignRecord(size_t size)
+{
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+size_t recordSize(size_t point_count, size_t id_length)
+{
+    return alignRecord(sizeof(CurveLibraryRecord) + point_count * sizeof(CurvePoint) +
+                       id_length * sizeof(wchar_t));
+}
+
+CurveLibraryRecord makeRecord(CurveLibraryRecord::Kind kind, const RampKey& key,
+                              const GammaRamp& ramp, size_t point_count, size_t id_length)
+{
+    CurveLibraryRecord record{};
+    record.kind = kind;
+    record.size = static_cast<uint32_t>(recordSize(point_count, id_length));
+    record.curve = static_cast<int32_t>(key.curve);
+    record.strength_q = key.strength_q;
+    record.curve_hash = key.curve_hash;
+    record.white_point_k = key.white_point_k;
+    record.point_count = static_cast<uint32_t>(point_count);
+    record.id_length = static_cast<uint32_t>(id_length);
+    record.ramp = ramp;
+    return record;
+}
+
+} // anonymous namespace
+
+CurveLibrary::~CurveLibrary()
+{
+    close();
+}
+
+void CurveLibrary::close()
+{
+    records_.clear();
+    if (base_) { UnmapViewOfFile(base_); base_ = nullptr; }
+    if (mapping_) { CloseHandle(mapping_); mapping_ = nullptr; }
+    if (file_ != INVALID_HANDLE_VALUE) { CloseHandle(file_); file_ = INVALID_HANDLE_VALUE; }
+}
+
+bool CurveLibrary::open(const std::filesystem::path& path)
+{
+    close();
+
+    // FILE_SHARE_DELETE lets a running instance replace the file while
+    // another process (a CLI launch) has it mapped
+    file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file_, &file_size) ||
+        file_size.QuadPart < static_cast<LONGLONG>(sizeof(CurveLibraryHeader))) {
+        close();
+        return false;
+    }
+
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_) {
+        base_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!base_) {
+        close();
+        return false;
+    }
+
+    // Check everything up front, so record() can trust the mapping
+    const size_t size = static_cast<size_t>(file_size.QuadPart);
+    const auto* header = reinterpret_cast<const CurveLibraryHeader*>(base_);
+    if (std::memcmp(header->magic, kCurveLibraryMagic, sizeof(kCurveLibraryMagic)) != 0 ||
+        header->version != kCurveLibraryVersion || header->file_size != size) {
+        close();
+        return false;
+    }
+
+    size_t offset = sizeof(CurveLibraryHeader);
+    for (uint32_t i = 0; i < header->record_count; ++i) {
+        if (size - offset < sizeof(CurveLibraryRecord)) break;
+        const auto* record = reinterpret_cast<const CurveLibraryRecord*>(base_ + offset);
+        bool valid = (record->kind == CurveLibraryRecord::Curve ||
+                      record->kind == CurveLibraryRecord::Accepted) &&
+                     record->curve >= 0 && record->curve < static_cast<int32_t>(kToneCurveCount) &&
+                     record->point_count <= (1u << 16) && record->id_length <= (1u << 15) &&
+                     record->size == recordSize(record->point_count, record->id_length) &&
+                     record->size <= size - offset;
+        if (!valid) break;
+        records_.push_back(record);
+        offset += record->size;
+    }
+    if (records_.size() != header->record_count) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+CurveLibrary::View CurveLibrary::record(size_t index) const
+{
+    const CurveLibraryRecord* record = records_[index];
+    const uint8_t* trailing = reinterpret_cast<const uint8_t*>(record + 1);
+
+    View view{};
+    view.kind = static_cast<CurveLibraryRecord::Kind>(record->kind);
+    view.key.curve = static_cast<ToneCurve>(record->curve);
+    view.key.strength_q = record->strength_q;
+    view.key.curve_hash = record->curve_hash;
+    view.key.white_point_k = record->white_point_k;
+    view.ramp = &record->ramp;
+    view.points = reinterpret_cast<const CurvePoint*>(trailing);
+    view.point_count = record->point_count;
+    view.monitor_id = std::wstring_view(
+        reinterpret_cast<const wchar_t*>(trailing + record->point_count * sizeof(CurvePoint)),
+        record->id_length);
+    return view;
+}
+
+std::string CurveLibrary::serialize(const std::vector<CurveLibraryCurve>& curves,
+                                   const std::vector<AcceptedRampRecord>& accepted)
+{
+    CurveLibraryHeader header{};
+    std::memcpy(header.magic, kCurveLibraryMagic, sizeof(kCurveLibraryMagic));
+    header.version = kCurveLibraryVersion;
+    header.record_count = static_cast<uint32_t>(curves.size() + accepted.size());
+    header.file_size = sizeof(CurveLibraryHeader);
+    for (const auto& curve : curves) {
+        header.file_size += recordSize(curve.points.size(), 0);
+    }
+    for (const auto& entry : accepted) {
+        header.file_size += recordSize(0, entry.monitor_id.size());
+    }
+
+    std::string data;
+    data.reserve(static_cast<size_t>(header.file_size));
+    auto append = [&](const void* bytes, size_t size) {
+        data.append(static_cast<const char*>(bytes), size);
+    };
+    auto append_record = [&](const CurveLibraryRecord& record, const void* trailing,
+                             size_t trailing_size) {
+        append(&record, sizeof(record));
+        if (trailing_size) append(trailing, trailing_size);
+        data.append(record.size - sizeof(record) - trailing_size, '\0');
+    };
+
+    append(&header, sizeof(header));
+    for (const auto& curve : curves) {
+        append_record(makeRecord(CurveLibraryRecord::Curve, curve.key, curve.ramp,
+                                 curve.points.size(), 0),
+                      curve.points.data(), curve.points.size() * sizeof(CurvePoint));
+    }
+    for (const auto& entry : accepted) {
+        append_record(makeRecord(CurveLibraryRecord::Accepted, entry.key, entry.ramp, 0,
+                                 entry.monitor_id.size()),
+                      entry.monitor_id.data(), entry.monitor_id.size() * sizeof(wchar_t));
+    }
+    return data;
+}
+
+} // namespace lumos::platform
@@ -0,0 +1,116 @@
+// Lumos - Binary curve library
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "gamma.h"
+
+namespace lumos::platform {
+
+// Ramps saved next to the INI so startup can push the last curve without
+// running buildRamp or the adaptive search. The file is a header followed
+// by self-sized records, read in place through a read-only memory map:
+//
+//   CurveLibraryHeader
+//   CurveLibraryRecord, <point_count> CurvePoint, <id_length> wchar_t, padding
+//   ...
+//
+// The INI and .curve text files stay the source of truth (and the
+// import/export format); a missing, stale or corrupt library only costs
+// the startup shortcut.
+constexpr char kCurveLibraryMagic[8] = {'L', 'U', 'M', 'O', 'S', 'C', 'R', 'V'};
+constexpr uint32_t kCurveLibraryVersion = 1;
+
+struct CurveLibraryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_count;
+    uint64_t file_size;
+};
+
+struct CurveLibraryRecord {
+    enum Kind : uint32_t {
+        Curve = 1,     // Ideal ramp for a curve, with its control points
+        Accepted = 2,  // Ramp one monitor accepted, with its monitor ID
+    };
+
+    uint32_t kind;
+    uint32_t size;  // Whole record including trailing data, multiple of 8
+    int32_t curve;
+    int32_t strength_q;
+    uint64_t curve_hash;
+    int32_t white_point_k;
+    uint32_t point_count;  // Trailing CurvePoints (Curve records)
+    uint32_t id_length;    // Trailing UTF-16 monitor ID (Accepted records)
+    uint32_t reserved;
+    GammaRamp ramp;
+};
+
+static_assert(sizeof(CurveLibraryHeader) == 24);
+static_assert(sizeof(CurveLibraryRecord) % 8 == 0);
+static_assert(sizeof(CurvePoint) == 16);
+
+// One curve to save: its key, control points (Custom only) and ideal ramp
+struct CurveLibraryCurve {
+    RampKey key;
+    std::vector<CurvePoint> points;
+    GammaRamp ramp;
+
+    bool operator==(const CurveLibraryCurve& other) const = default;
+};
+
+// Read-only view of a mapped library. Views returned by record() point into
+// the mapping and stay valid until close().
+class CurveLibrary {
+public:
+    CurveLibrary() = default;
+    ~CurveLibrary();
+
+    CurveLibrary(const CurveLibrary&) = delete;
+    CurveLibrary& operator=(const CurveLibrary&) = delete;
+
+    // Map the file and validate every record. False (and nothing mapped)
+    // if it is missing, from another version or malformed.
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    struct View {
+        CurveLibraryRecord::Kind kind;
+        RampKey key;
+        const GammaRamp* ramp;
+        const CurvePoint* points;
+        size_t point_count;
+        std::wstring_view monitor_id;
+    };
+
+    size_t size() const { return records_.size(); }
+    View record(size_t index) const;
+
+    // File contents for a library holding curves and accepted (written with
+    // Config::writeFileAtomic, so readers only see a complete file)
+    static std::string serialize(const std::vector<CurveLibraryCurve>& curves,
+                                 const std::vector<AcceptedRampRecord>& accepted);
+
+private:
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+    const uint8_t* base_ = nullptr;
+    std::vector<const CurveLibraryRecord*> records_;
+};
+
+} // namespace lumos::platform
@@ -3,45 +3,44 @@
 // License: GPL v2
 
 #include "gamma.h"
+#include "perf_trace.h"
+#include "tone_curve.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace lumos::platform {
 
-// Tone curve shape functions
-// NOTE: These are NOT calibrated transforms - they produce curve SHAPES
-// that happen to resemble certain standards, but are applied as simple
-// GPU output remaps with no device characterization or measurement.
-namespace {
-
-// Shadow-lifting curve (raises dark values, sRGB-like shape)
-double ShadowLiftCurve(double linear) {
-    if (linear <= 0.0031308)
-        return 12.92 * linear;
-    return 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+const GammaRamp* RampCache::find(const RampKey& key)
+{
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->key == key) {
+            entries_.splice(entries_.begin(), entries_, it);
+            return &entries_.front().ramp;
+        }
+    }
+    return nullptr;
 }
 
-// Soft contrast curve (gentle S-shape, Rec.709-like)
-double SoftContrastCurve(double linear) {
-    const double beta = 0.018;
-    const double alpha = 1.099;
-    const double gamma_exp = 0.45;
-
-    if (linear < beta)
-        return 4.5 * linear;
-    return alpha * std::pow(linear, gamma_exp) - (alpha - 1.0);
+void RampCache::insert(const RampKey& key, const GammaRamp& ramp)
+{
+    erase(key);
+    entries_.push_front({key, ramp});
+    while (entries_.size() > capacity_) {
+        entries_.pop_back();
+    }
 }
 
-// Simple power-law curve
-double PowerCurve(double linear, double strength) {
-    return std::pow(linear, 1.0 / strength);
+void RampCache::erase(const RampKey& key)
+{
+    entries_.remove_if([&key](const Entry& entry) { return entry.key == key; });
 }
 
-} // anonymous namespace
-
 Gamma::~Gamma()
 {
+    destroyApplyTasks();
     restoreAll();
+    invalidateDeviceContexts();
 }
 
 BOOL CALLBACK Gamma::MonitorEnumProc(HMONITOR hMonitor, HDC hdcMonitor,
@@ -64,14 +63,31 @@ BOOL CALLBACK Gamma::MonitorEnumProc(HMONITOR hMonitor, HDC hdcMonitor,
     info.friendly_name = mi.szDevice; // TODO: Get friendly name from registry
     info.is_primary = (mi.dwFlags & MONITORINFOF_PRIMARY) != 0;
     info.has_original = false;
+    info.device_id = mi.szDevice;  // Refined by resolveDeviceId
 
     monitors->push_back(info);
     return TRUE;
 }
 
-bool Gamma::initialize()
+void Gamma::resolveDeviceId(MonitorInfo& monitor)
 {
+    // The monitor's device interface path identifies the panel (it embeds
+    // the EDID vendor/product code), unlike \\.\DISPLAYn which follows the port
+    DISPLAY_DEVICEW dd = {};
+    dd.cb = sizeof(dd);
+    if (EnumDisplayDevicesW(monitor.device_name.c_str(), 0, &dd, EDD_GET_DEVICE_INTERFACE_NAME) &&
+        dd.DeviceID[0]) {
+        monitor.device_id = dd.DeviceID;
+    }
+}
+
+bool Gamma::initialize(const GammaInitOptions& options)
+{
+    destroyApplyTasks();
+    invalidateDeviceContexts();
     monitors_.clear();
+    departed_.clear();
+    options_ = options;
 
     // Enumerate all monitors
     EnumDisplayMonitors(nullptr, nullptr, MonitorEnumProc,
@@ -81,300 +97,499 @@ bool Gamma::initialize()
         return false;
     }
 
+    createApplyTasks();
+
+    if (options.resolve_device_ids) {
+        for (auto& monitor : monitors_) {
+            resolveDeviceId(monitor);
+        }
+    }
+
     // Capture original ramps for all monitors
     bool success = true;
-    for (auto& monitor : monitors_) {
-        if (!captureRamp(monitor)) {
-            success = false;
+    if (options.capture_original_ramps) {
+        for (auto& monitor : monitors_) {
+            if (!captureRamp(monitor)) {
+                success = false;
+            }
         }
     }
 
     return success;
 }
 
-bool Gamma::captureRamp(MonitorInfo& monitor)
+void Gamma::createApplyTasks()
 {
-    HDC hdc = CreateDCW(L"DISPLAY", monitor.device_name.c_str(), nullptr, nullptr);
-    if (!hdc) return false;
+    // A single monitor is applied inline, no pool needed
+    if (monitors_.size() < 2) return;
 
-    BOOL result = GetDeviceGammaRamp(hdc, &monitor.original_ramp);
-    DeleteDC(hdc);
+    for (size_t i = 0; i < monitors_.size(); ++i) {
+        auto task = std::make_unique<ApplyTask>();
+        task->gamma = this;
+        task->monitor_index = i;
+        task->work = CreateThreadpoolWork(ApplyWorkCallback, task.get(), nullptr);
+        if (!task->work) {
+            // Fall back to serial application
+            destroyApplyTasks();
+            return;
+        }
+        apply_tasks_.push_back(std::move(task));
+    }
+}
 
-    if (result) {
-        monitor.has_original = true;
+void Gamma::destroyApplyTasks()
+{
+    for (auto& task : apply_tasks_) {
+        WaitForThreadpoolWorkCallbacks(task->work, FALSE);
+        CloseThreadpoolWork(task->work);
     }
-    return result != FALSE;
+    apply_tasks_.clear();
 }
 
-bool Gamma::setRamp(const MonitorInfo& monitor, const GammaRamp& ramp)
+void CALLBACK Gamma::ApplyWorkCallback(PTP_CALLBACK_INSTANCE instance,
+                                       PVOID context, PTP_WORK work)
 {
-    HDC hdc = CreateDCW(L"DISPLAY", monitor.device_name.c_str(), nullptr, nullptr);
-    if (!hdc) return false;
+    (void)instance;
+    (void)work;
 
-    // Need non-const for SetDeviceGammaRamp
-    GammaRamp ramp_copy = ramp;
-    BOOL result = SetDeviceGammaRamp(hdc, &ramp_copy);
-    DeleteDC(hdc);
+    auto* task = static_cast<ApplyTask*>(context);
+    task->success = task->gamma->applyRampTimed(
+        task->gamma->monitors_[task->monitor_index], *task->key, *task->ramp);
+}
 
-    return result != FALSE;
+bool Gamma::applyRampTimed(MonitorInfo& monitor, const RampKey& key, const GammaRamp& ideal)
+{
+    LARGE_INTEGER freq, start, end;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+
+    bool result = false;
+    const GammaRamp* cached = monitor.accepted_ramps.find(key);
+    const bool trusted = verify_policy_ != VerifyPolicy::Full &&
+                         monitor.family_verified[static_cast<size_t>(key.curve)];
+    if (cached && setRamp(monitor, *cached) &&
+        (trusted || verifyRamp(monitor, key.curve, *cached) == RampReadback::Matched)) {
+        // Already verified on this monitor - no readback needed (except
+        // under VerifyPolicy::Full, which re-checks every push, and for
+        // ramps seeded from an earlier session)
+        result = true;
+    } else {
+        if (cached) {
+            monitor.accepted_ramps.erase(key);
+        }
+
+        GammaRamp accepted{};
+        result = applyRampAdaptive(monitor, key.curve, ideal, &accepted);
+        if (result) {
+            monitor.accepted_ramps.insert(key, accepted);
+        }
+        if (result || cached) {
+            accepted_generation_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (result) {
+        monitor.shown_key = key;
+        monitor.shows_key = true;
+    }
+
+    QueryPerformanceCounter(&end);
+    monitor.last_apply_ms = 1000.0 * static_cast<double>(end.QuadPart - start.QuadPart) /
+                            static_cast<double>(freq.QuadPart);
+    return result;
 }
 
-bool Gamma::readRamp(const MonitorInfo& monitor, GammaRamp& out_ramp) const
+HDC Gamma::acquireDC(const MonitorInfo& monitor) const
 {
-    HDC hdc = CreateDCW(L"DISPLAY", monitor.device_name.c_str(), nullptr, nullptr);
-    if (!hdc) return false;
+    if (!monitor.dc) {
+        monitor.dc = CreateDCW(L"DISPLAY", monitor.device_name.c_str(), nullptr, nullptr);
+        if (monitor.dc) {
+            dc_creations_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return monitor.dc;
+}
 
-    // GetDeviceGammaRamp expects WORD[3][256], which matches our GammaRamp layout
-    BOOL result = GetDeviceGammaRamp(hdc, &out_ramp);
-    DeleteDC(hdc);
+void Gamma::seedSafeScales(const std::vector<SafeScaleRecord>& records)
+{
+    for (const auto& record : records) {
+        size_t family = static_cast<size_t>(record.curve);
+        if (family >= kToneCurveCount) continue;
+        if (record.scale <= 0.0 || record.scale > 1.0) continue;
+        seed_records_.push_back(record);
+    }
+    for (auto& monitor : monitors_) {
+        applySeedRecords(monitor);
+    }
+}
 
-    return result != FALSE;
+void Gamma::applySeedRecords(MonitorInfo& monitor) const
+{
+    for (const auto& record : seed_records_) {
+        if (monitor.device_id == record.monitor_id) {
+            size_t family = static_cast<size_t>(record.curve);
+            monitor.safe_scale[family] = record.scale;
+            monitor.scale_known[family] = true;
+        }
+    }
 }
 
-bool Gamma::verifyRamp(const MonitorInfo& monitor, const GammaRamp& expected)
+std::vector<SafeScaleRecord> Gamma::getSafeScales() const
 {
-    GammaRamp actual{};
-    if (!readRamp(monitor, actual)) {
-        return false;
+    std::vector<SafeScaleRecord> records;
+    auto collect = [&records](const MonitorInfo& monitor) {
+        for (size_t family = 0; family < kToneCurveCount; ++family) {
+            if (monitor.scale_known[family]) {
+                records.push_back({monitor.device_id, static_cast<ToneCurve>(family),
+                                   monitor.safe_scale[family]});
+            }
+        }
+    };
+    for (const auto& monitor : monitors_) collect(monitor);
+    for (const auto& monitor : departed_) collect(monitor);
+    return records;
+}
+
+MonitorRefresh Gamma::refreshMonitors()
+{
+    MonitorRefresh refresh;
+
+    std::vector<MonitorInfo> found;
+    EnumDisplayMonitors(nullptr, nullptr, MonitorEnumProc, reinterpret_cast<LPARAM>(&found));
+    if (found.empty()) {
+        // Every output can vanish for a moment during a mode switch; keep
+        // the current state rather than forget it. The next change rescans.
+        invalidateDeviceContexts();
+        return refresh;
+    }
+    if (options_.resolve_device_ids) {
+        for (auto& monitor : found) {
+            resolveDeviceId(monitor);
+        }
     }
 
-    // Compare with tolerance. SetDeviceGammaRamp can round values slightly,
-    // so we allow a small epsilon. If the ramp was silently rejected, the
-    // actual values will be very different (often the previous ramp).
-    constexpr int kMaxDiff = 512;  // ~0.8% of 65535, allows for rounding
+    destroyApplyTasks();
+    invalidateDeviceContexts();
+
+    // Take the state of a known display out of a list, if it is there
+    auto claim = [](std::vector<MonitorInfo>& list, const std::wstring& device_id,
+                    MonitorInfo& out) {
+        auto it = std::find_if(list.begin(), list.end(),
+            [&](const MonitorInfo& m) { return m.device_id == device_id; });
+        if (it == list.end()) return false;
+        out = std::move(*it);
+        list.erase(it);
+        return true;
+    };
 
-    for (int i = 0; i < 256; ++i) {
-        int diff_r = std::abs(static_cast<int>(expected.red[i]) - static_cast<int>(actual.red[i]));
-        int diff_g = std::abs(static_cast<int>(expected.green[i]) - static_cast<int>(actual.green[i]));
-        int diff_b = std::abs(static_cast<int>(expected.blue[i]) - static_cast<int>(actual.blue[i]));
+    std::vector<MonitorInfo> previous = std::move(monitors_);
+    std::vector<std::wstring> previous_order;
+    for (const auto& monitor : previous) {
+        previous_order.push_back(monitor.device_id);
+    }
 
-        if (diff_r > kMaxDiff || diff_g > kMaxDiff || diff_b > kMaxDiff) {
-            return false;
+    for (size_t i = 0; i < found.size(); ++i) {
+        MonitorInfo& fresh = found[i];
+        MonitorInfo kept;
+        if (claim(previous, fresh.device_id, kept)) {
+            // Still connected: only the handle, port and primary flag move
+            kept.handle = fresh.handle;
+            kept.device_name = fresh.device_name;
+            kept.friendly_name = fresh.friendly_name;
+            kept.is_primary = fresh.is_primary;
+            fresh = std::move(kept);
+
+            // Mode changes and wake-ups can reset the ramp under us
+            GammaRamp actual{};
+            if (fresh.has_current &&
+                (!readRamp(fresh, actual) || !rampsMatch(fresh.current_ramp, actual))) {
+                fresh.shows_key = false;
+                refresh.reapply.push_back(i);
+            }
+            if (i >= previous_order.size() || previous_order[i] != fresh.device_id) {
+                refresh.changed = true;
+            }
+        } else if (claim(departed_, fresh.device_id, kept)) {
+            // Plugged back in: its original ramp is still the one captured
+            // before we touched it, but what it shows now is anyone's guess
+            kept.handle = fresh.handle;
+            kept.device_name = fresh.device_name;
+            kept.friendly_name = fresh.friendly_name;
+            kept.is_primary = fresh.is_primary;
+            kept.has_current = false;
+            kept.shows_key = false;
+            fresh = std::move(kept);
+            refresh.reapply.push_back(i);
+            refresh.changed = true;
+        } else {
+            if (options_.capture_original_ramps) {
+                captureRamp(fresh);
+            }
+            applySeedRecords(fresh);
+            refresh.reapply.push_back(i);
+            refresh.changed = true;
         }
     }
 
-    return true;
+    // Whatever is left was unplugged
+    for (auto& monitor : previous) {
+        departed_.push_back(std::move(monitor));
+        refresh.changed = true;
+    }
+    if (departed_.size() > kMaxDepartedMonitors) {
+        departed_.erase(departed_.begin(),
+                        departed_.end() - static_cast<std::ptrdiff_t>(kMaxDepartedMonitors));
+    }
+
+    monitors_ = std::move(found);
+    createApplyTasks();
+    return refresh;
 }
 
-GammaRamp Gamma::buildIdentityRamp()
+void Gamma::clearAcceptedRamps()
 {
-    GammaRamp ramp{};
-    for (int i = 0; i < 256; ++i) {
-        WORD val = static_cast<WORD>(i * 257);  // Maps 0-255 to 0-65535
-        ramp.red[i] = val;
-        ramp.green[i] = val;
-        ramp.blue[i] = val;
+    for (auto& monitor : monitors_) {
+        monitor.accepted_ramps.clear();
+        monitor.family_verified = {};
     }
-    return ramp;
 }
 
-GammaRamp Gamma::blendRampTowardIdentity(const GammaRamp& ramp,
-                                          const GammaRamp& identity,
-                                          double scale)
+void Gamma::seedBuiltRamp(const RampKey& key, const GammaRamp& ramp)
 {
-    GammaRamp result{};
-    for (int i = 0; i < 256; ++i) {
-        // Blend: identity + scale * (ramp - identity)
-        // When scale=1.0, result=ramp. When scale=0.0, result=identity.
-        double r = identity.red[i] + scale * (static_cast<double>(ramp.red[i]) - identity.red[i]);
-        double g = identity.green[i] + scale * (static_cast<double>(ramp.green[i]) - identity.green[i]);
-        double b = identity.blue[i] + scale * (static_cast<double>(ramp.blue[i]) - identity.blue[i]);
+    built_ramps_.insert(key, ramp);
+}
 
-        result.red[i] = static_cast<WORD>(std::clamp(r, 0.0, 65535.0));
-        result.green[i] = static_cast<WORD>(std::clamp(g, 0.0, 65535.0));
-        result.blue[i] = static_cast<WORD>(std::clamp(b, 0.0, 65535.0));
+void Gamma::seedAcceptedRamp(const std::wstring& monitor_id, const RampKey& key,
+                             const GammaRamp& ramp)
+{
+    if (static_cast<size_t>(key.curve) >= kToneCurveCount) return;
+    for (auto& monitor : monitors_) {
+        if (monitor.device_id == monitor_id) {
+            monitor.accepted_ramps.insert(key, ramp);
+        }
     }
-    return result;
 }
 
-void Gamma::enforceMonotonicity(GammaRamp& ramp)
+std::vector<AcceptedRampRecord> Gamma::getAcceptedRamps() const
 {
-    // Ensure ramp values are strictly increasing (or at least non-decreasing).
-    // Windows heuristics reject ramps with flat or decreasing segments.
-    // We enforce a minimum step of 1 to keep it strictly increasing.
-    constexpr WORD kMinStep = 1;
-
-    auto enforce_channel = [](std::array<WORD, 256>& channel) {
-        WORD prev = 0;
-        for (int i = 0; i < 256; ++i) {
-            if (channel[i] <= prev && i > 0) {
-                channel[i] = (prev < 65535 - kMinStep) ? prev + kMinStep : 65535;
-            }
-            prev = channel[i];
+    std::vector<AcceptedRampRecord> records;
+    auto collect = [&records](const MonitorInfo& monitor) {
+        const auto& entries = monitor.accepted_ramps.entries();
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+            records.push_back({monitor.device_id, it->key, it->ramp});
         }
     };
+    for (const auto& monitor : monitors_) collect(monitor);
+    for (const auto& monitor : departed_) collect(monitor);
+    return records;
+}
 
-    enforce_channel(ramp.red);
-    enforce_channel(ramp.green);
-    enforce_channel(ramp.blue);
+RampKey Gamma::makeRampKey(ToneCurve curve, double strength,
+                           const std::vector<CurvePoint>* custom_curve,
+                           CurveInterpolation interpolation,
+                           double white_point_k)
+{
+    RampKey key;
+    key.curve = curve;
+    double kelvin = std::clamp(white_point_k, kMinWhitePointK, kMaxWhitePointK);
+    key.white_point_k = static_cast<int32_t>(std::lround(kelvin / 10.0) * 10);
+    if (curve == ToneCurve::Power) {
+        double clamped = std::clamp(strength, 0.1, 9.0);
+        key.strength_q = static_cast<int32_t>(std::lround(clamped * 1000.0));
+    }
+    if (curve == ToneCurve::Custom && custom_curve) {
+        key.curve_hash = hashCurvePoints(*custom_curve);
+        if (interpolation == CurveInterpolation::MonotoneCubic) {
+            key.curve_hash = ~key.curve_hash;
+        }
+    }
+    return key;
 }
 
-bool Gamma::applyRampAdaptive(MonitorInfo& monitor, const GammaRamp& ideal)
+uint64_t Gamma::hashCurvePoints(const std::vector<CurvePoint>& points)
 {
-    static const GammaRamp identity = buildIdentityRamp();
+    // FNV-1a over the raw bits of each coordinate
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 8; ++i) {
+            hash ^= (bits >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const auto& pt : points) {
+        mix(pt.x);
+        mix(pt.y);
+    }
+    return hash;
+}
 
-    // Start with the monitor's cached safe scale, slightly expanded to probe
-    // whether we can use more range now
-    double scale = (std::min)(1.0, monitor.safe_scale * 1.05);
+const GammaRamp& Gamma::buildRampCached(const RampKey& key, ToneCurve curve, double strength,
+                                        const std::vector<CurvePoint>* custom_curve,
+                                        CurveInterpolation interpolation)
+{
+    if (const GammaRamp* cached = built_ramps_.find(key)) {
+        return *cached;
+    }
+    PerfScope timer(PerfStage::BuildRamp);
+    built_ramps_.insert(key, buildRamp(curve, strength, custom_curve, interpolation,
+                                       static_cast<double>(key.white_point_k)));
+    return *built_ramps_.find(key);
+}
 
-    // Binary search bounds
-    double low = 0.0;
-    double high = scale;
+void Gamma::setWhitePoint(double kelvin)
+{
+    white_point_k_ = std::clamp(kelvin, kMinWhitePointK, kMaxWhitePointK);
+}
 
-    constexpr int kMaxAttempts = 6;
-    GammaRamp last_good = identity;
-    bool any_success = false;
+void Gamma::invalidateDeviceContexts()
+{
+    for (auto& monitor : monitors_) {
+        if (monitor.dc) {
+            DeleteDC(monitor.dc);
+            monitor.dc = nullptr;
+        }
+    }
+}
 
-    for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
-        double try_scale = (attempt == 0) ? high : 0.5 * (low + high);
+bool Gamma::captureRamp(MonitorInfo& monitor)
+{
+    HDC hdc = acquireDC(monitor);
+    if (!hdc) return false;
 
-        GammaRamp blended = blendRampTowardIdentity(ideal, identity, try_scale);
-        enforceMonotonicity(blended);
+    BOOL result = GetDeviceGammaRamp(hdc, &monitor.original_ramp);
 
-        if (!setRamp(monitor, blended)) {
-            // Hard failure (API returned FALSE) - shrink range
-            high = try_scale;
-            continue;
-        }
+    if (result) {
+        monitor.has_original = true;
+    }
+    return result != FALSE;
+}
 
-        // SetDeviceGammaRamp returned TRUE, but it might have silently rejected
-        if (verifyRamp(monitor, blended)) {
-            // Success! Remember this scale and try to expand
-            low = try_scale;
-            last_good = blended;
-            any_success = true;
-            monitor.safe_scale = try_scale;
-
-            // If we're close enough to our target scale, stop
-            if (high - low < 0.02) {
-                break;
-            }
-        } else {
-            // Silent rejection - shrink range
-            high = try_scale;
-        }
+bool Gamma::setRamp(MonitorInfo& monitor, const GammaRamp& ramp)
+{
+    monitor.shows_key = false;
+    HDC hdc = acquireDC(monitor);
+    if (!hdc) return false;
+
+    // Need non-const for SetDeviceGammaRamp
+    GammaRamp ramp_copy = ramp;
+    BOOL result;
+    {
+        PerfScope timer(PerfStage::SetRamp);
+        result = SetDeviceGammaRamp(hdc, &ramp_copy);
     }
 
-    // Apply the best ramp we found
-    if (any_success) {
-        // If our last attempt wasn't the good one, re-apply
-        if (high != low) {
-            setRamp(monitor, last_good);
-        }
-        return true;
+    if (result) {
+        monitor.current_ramp = ramp;
+        monitor.has_current = true;
     }
+    return result != FALSE;
+}
 
-    // Complete failure - fall back to identity
-    setRamp(monitor, identity);
-    monitor.safe_scale = 0.1;  // Very conservative for next attempt
-    return false;
+bool Gamma::readRamp(const MonitorInfo& monitor, GammaRamp& out_ramp) const
+{
+    HDC hdc = acquireDC(monitor);
+    if (!hdc) return false;
+
+    // GetDeviceGammaRamp expects WORD[3][256], which matches our GammaRamp layout
+    static_assert(sizeof(GammaRamp) == sizeof(WORD) * 3 * 256);
+    BOOL result = GetDeviceGammaRamp(hdc, &out_ramp);
+
+    return result != FALSE;
 }
 
-GammaRamp Gamma::buildRamp(ToneCurve curve, double strength,
-                           const std::vector<CurvePoint>* custom_curve)
+RampReadback Gamma::verifyRamp(MonitorInfo& monitor, ToneCurve curve, const GammaRamp& expected)
 {
-    if (strength < 0.1) strength = 0.1;
-    if (strength > 9.0) strength = 9.0;
+    const size_t family = static_cast<size_t>(curve);
+    const bool first_check = !monitor.family_verified[family];
+    if (!first_check && verify_policy_ == VerifyPolicy::Trusted) {
+        return RampReadback::Matched;
+    }
 
-    GammaRamp ramp{};
-    for (int i = 0; i < 256; ++i) {
-        double linear = i / 255.0;
-        double corrected;
-
-        switch (curve) {
-            case ToneCurve::Linear:
-                corrected = linear;  // Identity - no change
-                break;
-
-            case ToneCurve::ShadowLift:
-                corrected = ShadowLiftCurve(linear);
-                break;
-
-            case ToneCurve::SoftContrast:
-                corrected = SoftContrastCurve(linear);
-                break;
-
-            case ToneCurve::Cinema:
-                corrected = PowerCurve(linear, 2.6);
-                break;
-
-            case ToneCurve::Custom:
-                if (custom_curve && custom_curve->size() >= 2) {
-                    // Linear interpolation between control points
-                    const auto& points = *custom_curve;
-
-                    // Find surrounding points
-                    if (linear <= points.front().x) {
-                        // Before first point
-                        corrected = points.front().y;
-                    }
-                    else if (linear >= points.back().x) {
-                        // After last point
-                        corrected = points.back().y;
-                    }
-                    else {
-                        // Interpolate between two points
-                        corrected = linear;  // Safe default
-                        for (size_t j = 0; j < points.size() - 1; ++j) {
-                            if (linear >= points[j].x && linear <= points[j + 1].x) {
-                                double x1 = points[j].x;
-                                double y1 = points[j].y;
-                                double x2 = points[j + 1].x;
-                                double y2 = points[j + 1].y;
-
-                                // Linear interpolation
-                                double t = (x2 > x1) ? (linear - x1) / (x2 - x1) : 0.0;
-                                corrected = y1 + t * (y2 - y1);
-                                break;
-                            }
-                        }
-                    }
-                }
-                else {
-                    // Fallback to linear (identity) if no valid curve
-                    corrected = linear;
-                }
-                break;
-
-            case ToneCurve::Power:
-            default:
-                corrected = PowerCurve(linear, strength);
-                break;
+    PerfScope timer(PerfStage::VerifyRamp);
+    GammaRamp actual{};
+    if (!readRamp(monitor, actual)) {
+        return RampReadback::Failed;
+    }
+
+    bool matched;
+    if (first_check || verify_policy_ == VerifyPolicy::Full) {
+        matched = rampsMatch(expected, actual);
+        if (matched) {
+            monitor.family_verified[family] = true;
         }
+    } else {
+        matched = rampsMatchSampled(expected, actual);
+    }
+    return matched ? RampReadback::Matched : RampReadback::Mismatched;
+}
+
+bool Gamma::applyRampAdaptive(MonitorInfo& monitor, ToneCurve curve, const GammaRamp& ideal,
+                              GammaRamp* accepted)
+{
+    static const GammaRamp identity = buildIdentityRamp();
 
-        // Clamp to valid range [0, 1]
-        // Note: We use expanded bounds here. The adaptive application layer
-        // (applyRampAdaptive) will scale back toward identity if Windows
-        // rejects the ramp. This allows us to request aggressive curves and
-        // get the maximum the driver will accept.
-        if (corrected < 0.0) corrected = 0.0;
-        if (corrected > 1.0) corrected = 1.0;
+    const size_t family = static_cast<size_t>(curve);
+    double& safe_scale = monitor.safe_scale[family];
 
-        // Optional soft bounds: keep values within a generous envelope around
-        // identity to increase likelihood of acceptance.
-        // Allow crushing blacks (min=0) and generous shadow lift (offset 0.2)
-        double identity_val = linear;
-        double min_allowed = 0.0;
-        double max_allowed = (std::min)(1.0, identity_val * 3.0 + 0.2);
-        if (corrected < min_allowed) corrected = min_allowed;
-        if (corrected > max_allowed) corrected = max_allowed;
+    auto set = [&](const GammaRamp& ramp) { return setRamp(monitor, ramp); };
+    auto verify = [&](const GammaRamp& ramp) { return verifyRamp(monitor, curve, ramp); };
 
-        WORD val = static_cast<WORD>(corrected * 65535.0);
-        ramp.red[i] = val;
-        ramp.green[i] = val;
-        ramp.blue[i] = val;
+    // Nothing learned this session, but a scale saved by an earlier one:
+    // start from it so a previously accepted setting takes one set
+    GammaRamp seeded{};
+    const GammaRamp* first_candidate = nullptr;
+    if (!monitor.envelope.learned && monitor.scale_known[family]) {
+        seeded = blendRampTowardIdentity(ideal, identity, safe_scale);
+        enforceMonotonicity(seeded);
+        first_candidate = &seeded;
     }
 
-    // Enforce monotonicity to help pass Windows heuristics
-    enforceMonotonicity(ramp);
+    RampSearchResult search = fitRampToEnvelope(ideal, monitor.envelope, first_candidate,
+                                                set, verify);
+    if (!search.success) {
+        // Not a per-level bound after all - bisect the blend scale instead.
+        // A known scale is tried exactly; otherwise expand slightly.
+        double scale = monitor.scale_known[family]
+            ? safe_scale
+            : (std::min)(1.0, safe_scale * 1.05);
+        const bool hard_failure = search.hard_failure;
+        search = searchRampScale(ideal, scale, set, verify);
+        search.hard_failure |= hard_failure;
+        if (search.success) {
+            learnAcceptedRamp(monitor.envelope, search.accepted);
+        }
+    }
 
-    return ramp;
+    if (search.success) {
+        // Remember the equivalent scale (persisted, and the fallback's start)
+        safe_scale = search.scale;
+        monitor.scale_known[family] = true;
+        if (accepted) {
+            *accepted = search.accepted;
+        }
+        return true;
+    }
+
+    // The device failed outright somewhere (mode switch, lock, RDP
+    // reconnect): that says nothing about what it accepts, so leave the
+    // envelope and scale as they were for the next attempt
+    if (search.hard_failure) {
+        return false;
+    }
+
+    // Complete failure - fall back to identity. The envelope keeps what it
+    // learned, so the next attempt doesn't restart from a blind tiny scale.
+    setRamp(monitor, identity);
+    safe_scale = (std::max)(0.1, safe_scale * 0.5);
+    monitor.scale_known[family] = false;
+    return false;
 }
 
 bool Gamma::restoreAll()
 {
     bool success = true;
-    for (const auto& monitor : monitors_) {
+    for (auto& monitor : monitors_) {
         if (monitor.has_original) {
             // Use direct setRamp for restore - original ramps should always be valid
             if (!setRamp(monitor, monitor.original_ramp)) {
@@ -391,12 +606,34 @@ bool Gamma::applyAll(double value)
 }
 
 bool Gamma::applyAll(ToneCurve curve, double strength,
-                     const std::vector<CurvePoint>* custom_curve)
+                     const std::vector<CurvePoint>* custom_curve,
+                     CurveInterpolation interpolation)
 {
-    GammaRamp ramp = buildRamp(curve, strength, custom_curve);
-    bool success = true;
-    for (auto& monitor : monitors_) {
-        if (!applyRampAdaptive(monitor, ramp)) {
+    RampKey key = makeRampKey(curve, strength, custom_curve, interpolation, white_point_k_);
+    const GammaRamp& ramp = buildRampCached(key, curve, strength, custom_curve, interpolation);
+
+    if (apply_tasks_.size() != monitors_.size()) {
+        bool success = true;
+        for (auto& monitor : monitors_) {
+            if (!applyRampTimed(monitor, key, ramp)) {
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    // Fan out to the thread pool, run the first monitor on this thread
+    for (size_t i = 1; i < apply_tasks_.size(); ++i) {
+        apply_tasks_[i]->key = &key;
+        apply_tasks_[i]->ramp = &ramp;
+        SubmitThreadpoolWork(apply_tasks_[i]->work);
+    }
+
+    bool success = applyRampTimed(monitors_[0], key, ramp);
+
+    for (size_t i = 1; i < apply_tasks_.size(); ++i) {
+        WaitForThreadpoolWorkCallbacks(apply_tasks_[i]->work, FALSE);
+        if (!apply_tasks_[i]->success) {
             success = false;
         }
     }
@@ -409,25 +646,180 @@ bool Gamma::apply(size_t monitor_index, double value)
 }
 
 bool Gamma::apply(size_t monitor_index, ToneCurve curve, double strength,
-                  const std::vector<CurvePoint>* custom_curve)
+                  const std::vector<CurvePoint>* custom_curve,
+                  CurveInterpolation interpolation)
 {
     if (monitor_index >= monitors_.size()) return false;
 
-    GammaRamp ramp = buildRamp(curve, strength, custom_curve);
-    return applyRampAdaptive(monitors_[monitor_index], ramp);
+    RampKey key = makeRampKey(curve, strength, custom_curve, interpolation, white_point_k_);
+    const GammaRamp& ramp = buildRampCached(key, curve, strength, custom_curve, interpolation);
+    return applyRampTimed(monitors_[monitor_index], key, ramp);
+}
+
+std::vector<const MonitorCurve*> Gamma::uniqueTargets(
+    const std::vector<MonitorCurve>& targets) const
+{
+    std::vector<const MonitorCurve*> latest(monitors_.size(), nullptr);
+    for (const auto& target : targets) {
+        if (target.monitor_index < latest.size()) {
+            latest[target.monitor_index] = &target;
+        }
+    }
+    latest.erase(std::remove(latest.begin(), latest.end(), nullptr), latest.end());
+    return latest;
+}
+
+bool Gamma::applyEach(const std::vector<MonitorCurve>& targets)
+{
+    // Ideal ramps are copied out: a handful of distinct curves could
+    // otherwise evict one another from built_ramps_
+    struct Job {
+        size_t monitor_index;
+        RampKey key;
+        GammaRamp ideal;
+    };
+    std::vector<Job> jobs;
+    for (const MonitorCurve* target : uniqueTargets(targets)) {
+        RampKey key = makeRampKey(target->curve, target->strength, target->custom_curve,
+                                  target->interpolation, white_point_k_);
+        const MonitorInfo& monitor = monitors_[target->monitor_index];
+        if (monitor.shows_key && monitor.shown_key == key) continue;
+        jobs.push_back({target->monitor_index, key,
+                        buildRampCached(key, target->curve, target->strength,
+                                        target->custom_curve, target->interpolation)});
+    }
+
+    bool success = true;
+    if (jobs.size() < 2 || apply_tasks_.size() != monitors_.size()) {
+        for (const auto& job : jobs) {
+            if (!applyRampTimed(monitors_[job.monitor_index], job.key, job.ideal)) {
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    // Same fan-out as applyAll, on the tasks of the monitors that changed
+    for (size_t j = 1; j < jobs.size(); ++j) {
+        ApplyTask& task = *apply_tasks_[jobs[j].monitor_index];
+        task.key = &jobs[j].key;
+        task.ramp = &jobs[j].ideal;
+        SubmitThreadpoolWork(task.work);
+    }
+
+    success = applyRampTimed(monitors_[jobs[0].monitor_index], jobs[0].key, jobs[0].ideal);
+
+    for (size_t j = 1; j < jobs.size(); ++j) {
+        ApplyTask& task = *apply_tasks_[jobs[j].monitor_index];
+        WaitForThreadpoolWorkCallbacks(task.work, FALSE);
+        if (!task.success) {
+            success = false;
+        }
+    }
+    return success;
 }
 
 bool Gamma::restore(size_t monitor_index)
 {
     if (monitor_index >= monitors_.size()) return false;
 
-    const auto& monitor = monitors_[monitor_index];
+    auto& monitor = monitors_[monitor_index];
     if (!monitor.has_original) return false;
 
     // Use direct setRamp for restore - original ramps should always be valid
     return setRamp(monitor, monitor.original_ramp);
 }
 
+GammaRamp Gamma::predictAcceptedRamp(MonitorInfo& monitor, const RampKey& key,
+                                     const GammaRamp& ideal)
+{
+    static const GammaRamp identity = buildIdentityRamp();
+
+    if (const GammaRamp* cached = monitor.accepted_ramps.find(key)) {
+        return *cached;
+    }
+
+    // Not seen yet: aim where the adaptive apply makes its first attempt,
+    // the projection onto the envelope (or a saved scale before it has
+    // learned anything). A rejection may still change the result, which
+    // the final verified apply takes care of.
+    if (monitor.envelope.learned) {
+        return projectOntoEnvelope(ideal, monitor.envelope, true);
+    }
+    const size_t family = static_cast<size_t>(key.curve);
+    if (!monitor.scale_known[family]) {
+        return ideal;
+    }
+    GammaRamp blended = blendRampTowardIdentity(ideal, identity, monitor.safe_scale[family]);
+    enforceMonotonicity(blended);
+    return blended;
+}
+
+GammaTransition Gamma::prepareTransition(const std::vector<MonitorCurve>& targets,
+                                         size_t frame_count)
+{
+    static const GammaRamp identity = buildIdentityRamp();
+
+    GammaTransition transition;
+    transition.frame_count = frame_count;
+    if (frame_count == 0) return transition;
+
+    for (const MonitorCurve* target : uniqueTargets(targets)) {
+        MonitorInfo& monitor = monitors_[target->monitor_index];
+        RampKey key = makeRampKey(target->curve, target->strength, target->custom_curve,
+                                  target->interpolation, white_point_k_);
+        if (monitor.shows_key && monitor.shown_key == key) continue;
+
+        const GammaRamp& ideal = buildRampCached(key, target->curve, target->strength,
+                                                 target->custom_curve, target->interpolation);
+        const GammaRamp& from = monitor.has_current ? monitor.current_ramp
+                              : monitor.has_original ? monitor.original_ramp
+                              : identity;
+
+        GammaTransition::Track track;
+        track.monitor_index = target->monitor_index;
+        buildTransitionFrames(from, predictAcceptedRamp(monitor, key, ideal),
+                              frame_count, track.frames);
+        transition.tracks.push_back(std::move(track));
+    }
+    return transition;
+}
+
+GammaTransition Gamma::prepareRestoreTransition(size_t frame_count)
+{
+    GammaTransition transition;
+    transition.frame_count = frame_count;
+    if (frame_count == 0) return transition;
+
+    for (size_t i = 0; i < monitors_.size(); ++i) {
+        const MonitorInfo& monitor = monitors_[i];
+        if (!monitor.has_original || !monitor.has_current) continue;
+
+        GammaTransition::Track track;
+        track.monitor_index = i;
+        buildTransitionFrames(monitor.current_ramp, monitor.original_ramp,
+                              frame_count, track.frames);
+        transition.tracks.push_back(std::move(track));
+    }
+    return transition;
+}
+
+bool Gamma::applyTransitionFrame(const GammaTransition& transition, size_t frame)
+{
+    if (frame >= transition.frame_count) return false;
+
+    // Frames lie between two ramps the driver already took (or is about to
+    // be asked for with verification), so they go out unverified
+    bool success = true;
+    for (const auto& track : transition.tracks) {
+        if (track.monitor_index >= monitors_.size()) continue;
+        if (!setRamp(monitors_[track.monitor_index], track.frames[frame])) {
+            success = false;
+        }
+    }
+    return success;
+}
+
 const MonitorInfo* Gamma::getMonitor(size_t index) const
 {
     if (index >= monitors_.size()) return nullptr;
@@ -465,14 +857,8 @@ double Gamma::read() const
     size_t primary = getPrimaryIndex();
     const auto& monitor = monitors_[primary];
 
-    HDC hdc = CreateDCW(L"DISPLAY", monitor.device_name.c_str(), nullptr, nullptr);
-    if (!hdc) return 1.0;
-
     GammaRamp ramp{};
-    BOOL result = GetDeviceGammaRamp(hdc, &ramp);
-    DeleteDC(hdc);
-
-    if (!result) return 1.0;
+    if (!readRamp(monitor, ramp)) return 1.0;
 
     // Sample middle value to estimate gamma
     double normalized_in = 128.0 / 255.0;
@@ -14,51 +14,180 @@
 
 #include <windows.h>
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
 #include <vector>
 #include <string>
+#include "gamma_types.h"
+#include "ramp_math.h"
 
 namespace lumos::platform {
 
-// Custom curve control point
-struct CurvePoint {
-    double x;  // Input (0.0 - 1.0)
-    double y;  // Output (0.0 - 1.0)
+// How much of each ramp push is read back to catch silent rejections.
+// GetDeviceGammaRamp is a full GDI round trip, as expensive as the set.
+enum class VerifyPolicy {
+    Full,     // Compare every entry after every set, cached ramps included
+    Sampled,  // Full check the first time a monitor accepts a curve family,
+              // then kRampSampleCount entries; cached ramps skip readback
+    Trusted,  // After that first full check, trust the API return value
+};
 
-    // For sorting by x-coordinate
-    bool operator<(const CurvePoint& other) const { return x < other.x; }
+// Identifies a built ramp. Strength is quantized and only meaningful for
+// ToneCurve::Power (the other presets ignore it); the custom curve is
+// represented by a hash of its control points and interpolation. The
+// white point tints all curves, so it is always part of the key.
+struct RampKey {
+    ToneCurve curve = ToneCurve::Linear;
+    int32_t strength_q = 0;   // strength * 1000, rounded
+    uint64_t curve_hash = 0;  // hashCurvePoints() for Custom, else 0
+    int32_t white_point_k = static_cast<int32_t>(kNeutralWhitePointK);  // Rounded to 10 K
+
+    bool operator==(const RampKey& other) const = default;
 };
 
-// Tone curve presets for GPU output remapping
-// NOTE: These are NOT calibrated color-space transforms - they are simple
-// 1D LUTs applied globally via SetDeviceGammaRamp, affecting the entire desktop.
-enum class ToneCurve {
-    Linear,       // Identity curve (no adjustment)
-    Power,        // Simple power-law gamma curve
-    ShadowLift,   // Lifts shadow detail (sRGB-like shape, NOT actual sRGB)
-    SoftContrast, // Gentle S-curve contrast (Rec.709-like shape)
-    Cinema,       // Aggressive gamma 2.6 curve
-    Custom,       // User-defined curve with control points
+// Small fixed-capacity LRU cache of ramps, most recently used first.
+// Sized for a handful of presets/hotkey steps, so a linear scan is fine.
+class RampCache {
+public:
+    RampCache() = default;
+    explicit RampCache(size_t capacity) : capacity_(capacity) {}
+
+    // Look up a ramp and mark it most recently used (nullptr if absent)
+    const GammaRamp* find(const RampKey& key);
+
+    // Insert or replace a ramp, evicting the least recently used entry
+    void insert(const RampKey& key, const GammaRamp& ramp);
+
+    void erase(const RampKey& key);
+    void clear() { entries_.clear(); }
+    size_t size() const { return entries_.size(); }
+
+    struct Entry {
+        RampKey key;
+        GammaRamp ramp;
+    };
+
+    // Most recently used first
+    const std::list<Entry>& entries() const { return entries_; }
+
+private:
+    std::list<Entry> entries_;
+    size_t capacity_ = 16;
 };
 
-struct GammaRamp {
-    std::array<WORD, 256> red;
-    std::array<WORD, 256> green;
-    std::array<WORD, 256> blue;
+// A ramp one monitor accepted, for persistence across sessions
+struct AcceptedRampRecord {
+    std::wstring monitor_id;  // MonitorInfo::device_id
+    RampKey key;
+    GammaRamp ramp;
+
+    bool operator==(const AcceptedRampRecord& other) const = default;
+};
+
+// Persistable adaptive-scale entry for one monitor and curve family
+struct SafeScaleRecord {
+    std::wstring monitor_id;  // MonitorInfo::device_id (or device_name if unavailable)
+    ToneCurve curve = ToneCurve::Power;
+    double scale = 1.0;
 };
 
 struct MonitorInfo {
     HMONITOR handle;
     std::wstring device_name;
     std::wstring friendly_name;
+    std::wstring device_id;  // Monitor device interface path (EDID vendor/product), stable across restarts
     bool is_primary;
     GammaRamp original_ramp;
     bool has_original;
 
-    // Adaptive ramp scaling: cached "safe" scale factor for this monitor.
-    // When applying ramps that push boundaries, we scale deviation from
-    // identity by this factor. Starts at 1.0 (full strength) and shrinks
-    // if Windows rejects the ramp. Grows slowly after successes.
-    double safe_scale = 1.0;
+    // Adaptive ramp scaling: cached "safe" scale factor for this monitor,
+    // one per curve family (indexed by ToneCurve) since drivers accept
+    // different amounts of each shape. When applying ramps that push
+    // boundaries, we scale deviation from identity by this factor. Starts
+    // at 1.0 (full strength) and shrinks if Windows rejects the ramp. Grows
+    // slowly after successes.
+    std::array<double, kToneCurveCount> safe_scale = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+
+    // Whether safe_scale[curve] is known to be accepted (learned this
+    // session or seeded from config). Until the envelope below has learned
+    // anything, a known scale is tried as-is first, so a previously
+    // accepted setting applies with one set/verify pair.
+    std::array<bool, kToneCurveCount> scale_known{};
+
+    // Per-level deviation from identity this monitor's driver accepts,
+    // learned from every verified set. Shared by all curves (the driver
+    // checks the ramp, not the curve that made it); ideal ramps are
+    // projected onto it so most applies take a single set.
+    RampEnvelope envelope;
+
+    // Cached display DC used for all ramp get/set calls on this monitor.
+    // Created on first use and kept until Gamma::invalidateDeviceContexts()
+    // (display change / device removal) or destruction. Owned by Gamma.
+    mutable HDC dc = nullptr;
+
+    // Wall time of the last adaptive apply on this monitor, in milliseconds
+    double last_apply_ms = 0.0;
+
+    // Ramps this monitor has already accepted (after adaptive blending),
+    // keyed by the request that produced them. A hit is pushed with a single
+    // SetDeviceGammaRamp, skipping the build math and the adaptive search.
+    RampCache accepted_ramps;
+
+    // Whether a ramp of each curve family has passed a full readback check
+    // on this monitor. Until then every verification is full, whatever the
+    // policy; cleared with the accepted ramps.
+    std::array<bool, kToneCurveCount> family_verified{};
+
+    // Last ramp successfully pushed to this monitor, where an animated
+    // transition starts from
+    GammaRamp current_ramp{};
+    bool has_current = false;
+
+    // Request whose accepted ramp is on screen, so applyEach can skip a
+    // monitor whose curve didn't change. Any other push (restore, a
+    // transition frame) clears shows_key.
+    RampKey shown_key{};
+    bool shows_key = false;
+};
+
+// One monitor's curve in an applyEach / prepareTransition call
+struct MonitorCurve {
+    size_t monitor_index = 0;
+    ToneCurve curve = ToneCurve::Power;
+    double strength = 1.0;
+    const std::vector<CurvePoint>* custom_curve = nullptr;  // Custom only, must outlive the call
+    CurveInterpolation interpolation = CurveInterpolation::Linear;
+};
+
+// Precomputed animation from each monitor's current ramp toward a target.
+// Every intermediate ramp is built up front, so stepping is one
+// SetDeviceGammaRamp per monitor and frame; the target itself is not a
+// frame and goes through the normal verified apply at the end.
+struct GammaTransition {
+    struct Track {
+        size_t monitor_index = 0;
+        std::vector<GammaRamp> frames;
+    };
+    std::vector<Track> tracks;
+    size_t frame_count = 0;  // Intermediate frames per track
+
+    bool empty() const { return tracks.empty() || frame_count == 0; }
+};
+
+// What Gamma::initialize gathers up front. The GUI wants everything; a
+// one-shot CLI apply only needs monitor handles, and skipping the capture
+// also means the destructor has nothing to restore.
+struct GammaInitOptions {
+    bool capture_original_ramps = true;  // Required for restore/reset
+    bool resolve_device_ids = true;      // Required for persisted per-monitor state
+};
+
+// What Gamma::refreshMonitors found when diffing a new enumeration
+struct MonitorRefresh {
+    bool changed = false;         // Displays were added, removed or reordered
+    std::vector<size_t> reapply;  // Indices (new list) that need the active curve again
 };
 
 class Gamma {
@@ -67,7 +196,7 @@ public:
     ~Gamma();
 
     // Enumerate monitors and capture original ramps
-    bool initialize();
+    bool initialize(const GammaInitOptions& options = {});
 
     // Restore all original gamma ramps
     bool restoreAll();
@@ -75,16 +204,46 @@ public:
     // Apply tone curve to all monitors
     bool applyAll(double value);
     bool applyAll(ToneCurve curve, double strength,
-                  const std::vector<CurvePoint>* custom_curve = nullptr);
+                  const std::vector<CurvePoint>* custom_curve = nullptr,
+                  CurveInterpolation interpolation = CurveInterpolation::Linear);
 
     // Apply tone curve to specific monitor
     bool apply(size_t monitor_index, double value);
     bool apply(size_t monitor_index, ToneCurve curve, double strength,
-               const std::vector<CurvePoint>* custom_curve = nullptr);
+               const std::vector<CurvePoint>* custom_curve = nullptr,
+               CurveInterpolation interpolation = CurveInterpolation::Linear);
+
+    // Apply a curve per monitor (mixed panels with their own profiles),
+    // fanned out like applyAll. Monitors already showing the ramp for their
+    // curve are skipped, so changing one display's curve costs one set.
+    // A monitor listed twice takes its last entry.
+    bool applyEach(const std::vector<MonitorCurve>& targets);
 
     // Restore specific monitor
     bool restore(size_t monitor_index);
 
+    // White point applied to every ramp built from now on (per-channel
+    // gains on top of the tone curve, set in the same SetDeviceGammaRamp)
+    void setWhitePoint(double kelvin);
+    double getWhitePoint() const { return white_point_k_; }
+
+    // Readback verification used by every apply from now on
+    void setVerifyPolicy(VerifyPolicy policy) { verify_policy_ = policy; }
+    VerifyPolicy getVerifyPolicy() const { return verify_policy_; }
+
+    // Precompute frame_count intermediate ramps from each target monitor's
+    // current ramp toward the ramp it will accept for its curve. Targets
+    // come from the accepted-ramp cache or the learned safe scale, so no
+    // frame needs an adaptive probe. Monitors already there get no track.
+    GammaTransition prepareTransition(const std::vector<MonitorCurve>& targets,
+                                      size_t frame_count);
+
+    // Same, toward the captured original ramps
+    GammaTransition prepareRestoreTransition(size_t frame_count);
+
+    // Push one precomputed frame to every track (no verification)
+    bool applyTransitionFrame(const GammaTransition& transition, size_t frame);
+
     // Get monitor count
     size_t getMonitorCount() const { return monitors_.size(); }
 
@@ -94,6 +253,58 @@ public:
     // Get primary monitor index
     size_t getPrimaryIndex() const;
 
+    // Drop all cached display DCs (call on WM_DISPLAYCHANGE / device removal).
+    // They are recreated lazily on the next ramp call.
+    void invalidateDeviceContexts();
+
+    // Re-enumerate after a display change and diff against the current list
+    // by device ID. Displays still present keep their original ramp, learned
+    // scales, envelope and caches; only new ones are captured. A display
+    // that comes back after being unplugged gets its old state back. Outputs
+    // that are new, or whose ramp the driver reset, are listed in reapply.
+    // DCs are always dropped, since a mode change can invalidate them.
+    MonitorRefresh refreshMonitors();
+
+    // Seed adaptive scales from previously saved records (call after
+    // initialize). Records for monitors not present now are kept and used
+    // if the monitor is connected later.
+    void seedSafeScales(const std::vector<SafeScaleRecord>& records);
+
+    // Scales accepted on the current and unplugged monitors, for persistence
+    std::vector<SafeScaleRecord> getSafeScales() const;
+
+    // Forget every monitor's accepted ramps (e.g. after a topology change),
+    // forcing the next apply to re-probe with verification
+    void clearAcceptedRamps();
+
+    // Ramps saved by an earlier session (call after initialize, before the
+    // first apply). A seeded ideal ramp skips buildRamp; a seeded accepted
+    // ramp skips the adaptive search and is read back in full the first
+    // time it is pushed, since the driver may have changed since.
+    void seedBuiltRamp(const RampKey& key, const GammaRamp& ramp);
+    void seedAcceptedRamp(const std::wstring& monitor_id, const RampKey& key,
+                          const GammaRamp& ramp);
+
+    // Every monitor's accepted ramps (connected or not), least recently
+    // used first so seeding them back reproduces each cache's order
+    std::vector<AcceptedRampRecord> getAcceptedRamps() const;
+
+    // Bumped whenever a monitor learns or drops an accepted ramp, so
+    // callers only copy getAcceptedRamps() when it has something new
+    uint64_t getAcceptedRampGeneration() const { return accepted_generation_.load(); }
+
+    // Cache key for a tone curve request
+    static RampKey makeRampKey(ToneCurve curve, double strength,
+                               const std::vector<CurvePoint>* custom_curve = nullptr,
+                               CurveInterpolation interpolation = CurveInterpolation::Linear,
+                               double white_point_k = kNeutralWhitePointK);
+
+    // Stable hash of a custom curve's control points
+    static uint64_t hashCurvePoints(const std::vector<CurvePoint>& points);
+
+    // Total number of display DCs created so far (for diagnostics)
+    uint64_t getDcCreationCount() const { return dc_creations_.load(std::memory_order_relaxed); }
+
     // Legacy single-monitor interface (operates on primary)
     bool captureOriginal();
     bool restoreOriginal();
@@ -103,38 +314,92 @@ public:
 
 private:
     std::vector<MonitorInfo> monitors_;
+    GammaInitOptions options_;
+    mutable std::atomic<uint64_t> dc_creations_{0};
+    std::atomic<uint64_t> accepted_generation_{0};  // Bumped from apply tasks too
+
+    // Saved scales, applied to monitors as they appear
+    std::vector<SafeScaleRecord> seed_records_;
+    void applySeedRecords(MonitorInfo& monitor) const;
+
+    // Monitors unplugged this session, most recent last, so a display that
+    // comes back (dock, KVM, power cycle) skips the capture and re-probe
+    static constexpr size_t kMaxDepartedMonitors = 8;
+    std::vector<MonitorInfo> departed_;
+    double white_point_k_ = kNeutralWhitePointK;
+    VerifyPolicy verify_policy_ = VerifyPolicy::Sampled;
+
+    // One thread pool work item per monitor. applyAll fans the adaptive
+    // apply out across them, so total latency is the slowest monitor
+    // instead of the sum of all monitors.
+    struct ApplyTask {
+        Gamma* gamma = nullptr;
+        size_t monitor_index = 0;
+        const RampKey* key = nullptr;
+        const GammaRamp* ramp = nullptr;
+        bool success = false;
+        PTP_WORK work = nullptr;
+    };
+    std::vector<std::unique_ptr<ApplyTask>> apply_tasks_;
+
+    static void CALLBACK ApplyWorkCallback(PTP_CALLBACK_INSTANCE instance,
+                                           PVOID context, PTP_WORK work);
+    void createApplyTasks();
+    void destroyApplyTasks();
+
+    // Built (ideal) ramps, shared by all monitors. Only touched by the
+    // thread calling applyAll/apply, before any fan-out.
+    RampCache built_ramps_;
+
+    // Targets in range, one per monitor (the last entry wins), in monitor
+    // order. A monitor must never appear twice in a fan-out: its task
+    // would be submitted twice or race the calling thread.
+    std::vector<const MonitorCurve*> uniqueTargets(const std::vector<MonitorCurve>& targets) const;
+
+    // Return the ideal ramp for key, building it on a cache miss
+    const GammaRamp& buildRampCached(const RampKey& key, ToneCurve curve, double strength,
+                                     const std::vector<CurvePoint>* custom_curve,
+                                     CurveInterpolation interpolation);
+
+    // Push a previously accepted ramp for key if there is one, otherwise run
+    // applyRampAdaptive and remember what the monitor accepted. Timed into
+    // monitor.last_apply_ms.
+    bool applyRampTimed(MonitorInfo& monitor, const RampKey& key, const GammaRamp& ideal);
+
+    // The ramp applyRampTimed is expected to settle on for key, without
+    // touching the device: the cached accepted ramp, else ideal blended by
+    // the known safe scale
+    GammaRamp predictAcceptedRamp(MonitorInfo& monitor, const RampKey& key,
+                                  const GammaRamp& ideal);
 
     static BOOL CALLBACK MonitorEnumProc(HMONITOR hMonitor, HDC hdcMonitor,
                                           LPRECT lprcMonitor, LPARAM dwData);
+    static void resolveDeviceId(MonitorInfo& monitor);
 
     bool captureRamp(MonitorInfo& monitor);
 
-    // Low-level ramp application (no verification)
-    bool setRamp(const MonitorInfo& monitor, const GammaRamp& ramp);
+    // Return the monitor's cached display DC, creating it if needed
+    HDC acquireDC(const MonitorInfo& monitor) const;
+
+    // Low-level ramp application (no verification). Records the ramp as
+    // monitor.current_ramp when the driver takes it.
+    bool setRamp(MonitorInfo& monitor, const GammaRamp& ramp);
 
     // Read current ramp from monitor
     bool readRamp(const MonitorInfo& monitor, GammaRamp& out_ramp) const;
 
-    // Verify that a ramp was actually applied (SetDeviceGammaRamp can fail silently)
-    bool verifyRamp(const MonitorInfo& monitor, const GammaRamp& expected);
-
-    // Apply ramp with adaptive fallback: if Windows rejects it, blend toward
-    // identity and retry. Updates monitor.safe_scale on success/failure.
-    bool applyRampAdaptive(MonitorInfo& monitor, const GammaRamp& ideal);
-
-    // Build identity ramp (linear 1:1 mapping)
-    static GammaRamp buildIdentityRamp();
-
-    // Blend ramp toward identity by factor s (0=identity, 1=full ramp)
-    static GammaRamp blendRampTowardIdentity(const GammaRamp& ramp,
-                                              const GammaRamp& identity,
-                                              double scale);
-
-    // Enforce monotonicity: ensure ramp values are strictly increasing
-    static void enforceMonotonicity(GammaRamp& ramp);
-
-    static GammaRamp buildRamp(ToneCurve curve, double strength,
-                               const std::vector<CurvePoint>* custom_curve = nullptr);
+    // Verify that a ramp was actually applied (SetDeviceGammaRamp can fail
+    // silently), as thoroughly as verify_policy_ and the monitor's history
+    // with this curve family call for
+    RampReadback verifyRamp(MonitorInfo& monitor, ToneCurve curve, const GammaRamp& expected);
+
+    // Apply ramp with adaptive fallback: project it onto the monitor's
+    // learned envelope and refine on rejection, or (if the driver doesn't
+    // fit that model) bisect a blend toward identity. Updates
+    // monitor.safe_scale[curve] and stores the ramp that was finally
+    // accepted in *accepted (if given).
+    bool applyRampAdaptive(MonitorInfo& monitor, ToneCurve curve, const GammaRamp& ideal,
+                           GammaRamp* accepted = nullptr);
 };
 
 } // namespace lumos::platform
@@ -0,0 +1,62 @@
+// Lumos - Gamma ramp and tone curve types
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+// Plain data shared by the Win32 gamma module and the pure ramp math.
+// No <windows.h> here, so the math (and lumos_bench) builds without it.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace lumos::platform {
+
+// Custom curve control point
+struct CurvePoint {
+    double x;  // Input (0.0 - 1.0)
+    double y;  // Output (0.0 - 1.0)
+
+    // For sorting by x-coordinate
+    bool operator<(const CurvePoint& other) const { return x < other.x; }
+    bool operator==(const CurvePoint& other) const = default;
+};
+
+// How a custom curve is interpolated between its control points
+enum class CurveInterpolation {
+    Linear,         // Straight segments
+    MonotoneCubic,  // Smooth, without overshoot between points (Fritsch-Carlson)
+};
+
+// Tone curve presets for GPU output remapping
+// NOTE: These are NOT calibrated color-space transforms - they are simple
+// 1D LUTs applied globally via SetDeviceGammaRamp, affecting the entire desktop.
+enum class ToneCurve {
+    Linear,       // Identity curve (no adjustment)
+    Power,        // Simple power-law gamma curve
+    ShadowLift,   // Lifts shadow detail (sRGB-like shape, NOT actual sRGB)
+    SoftContrast, // Gentle S-curve contrast (Rec.709-like shape)
+    Cinema,       // Aggressive gamma 2.6 curve
+    Custom,       // User-defined curve with control points
+};
+
+// Number of ToneCurve values (for per-curve tables)
+constexpr size_t kToneCurveCount = 6;
+
+// White point that leaves all three channels untouched, and the supported
+// range for night-light style warming (or cooling)
+constexpr double kNeutralWhitePointK = 6500.0;
+constexpr double kMinWhitePointK = 1900.0;
+constexpr double kMaxWhitePointK = 10000.0;
+
+// Same layout as the WORD[3][256] SetDeviceGammaRamp expects
+struct GammaRamp {
+    std::array<uint16_t, 256> red;
+    std::array<uint16_t, 256> green;
+    std::array<uint16_t, 256> blue;
+
+    bool operator==(const GammaRamp& other) const = default;
+};
+
+} // namespace lumos::platform
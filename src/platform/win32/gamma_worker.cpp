@@ -0,0 +1,393 @@
+// Lumos - Asynchronous gamma apply worker
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#include "gamma_worker.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace lumos::platform {
+
+GammaWorker::~GammaWorker()
+{
+    stop();
+}
+
+bool GammaWorker::start(Gamma& gamma)
+{
+    if (running_) return true;
+
+    wake_event_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    completion_event_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!wake_event_ || !completion_event_) {
+        stop();
+        return false;
+    }
+
+    // High-resolution timers (Windows 10 1803+) fire on time instead of on
+    // the next 15.6 ms scheduler tick; fall back to a regular one
+    frame_timer_ = CreateWaitableTimerExW(nullptr, nullptr,
+                                          CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                          TIMER_ALL_ACCESS);
+    if (!frame_timer_) {
+        frame_timer_ = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+    }
+    QueryPerformanceFrequency(&qpc_frequency_);
+    rescan_timer_ = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+
+    gamma_ = &gamma;
+    has_last_request_ = false;
+    publishTopology();
+    copied_accepted_generation_ = ~gamma.getAcceptedRampGeneration();
+    publishAcceptedRamps();
+    running_ = true;
+    worker_thread_ = std::thread(&GammaWorker::workerThread, this);
+    return true;
+}
+
+void GammaWorker::stop()
+{
+    running_ = false;
+    if (wake_event_) {
+        SetEvent(wake_event_);
+    }
+    if (worker_thread_.joinable()) {
+        worker_thread_.join();
+    }
+
+    if (wake_event_) { CloseHandle(wake_event_); wake_event_ = nullptr; }
+    if (completion_event_) { CloseHandle(completion_event_); completion_event_ = nullptr; }
+    if (frame_timer_) { CloseHandle(frame_timer_); frame_timer_ = nullptr; }
+    if (rescan_timer_) { CloseHandle(rescan_timer_); rescan_timer_ = nullptr; }
+    transition_ = ActiveTransition{};
+    gamma_ = nullptr;
+}
+
+uint64_t GammaWorker::post(GammaRequest request)
+{
+    request.sequence = posted_seq_.load(std::memory_order_relaxed) + 1;
+    uint64_t sequence = request.sequence;
+
+    // Whatever the worker hadn't consumed yet comes back to us and is
+    // simply overwritten by the next post - that's the "latest wins"
+    // coalescing
+    requests_.back() = std::move(request);
+    requests_.publish();
+
+    posted_seq_.store(sequence, std::memory_order_release);
+    if (wake_event_) {
+        SetEvent(wake_event_);
+    }
+    return sequence;
+}
+
+void GammaWorker::requestTopologyRescan()
+{
+    if (rescan_timer_) {
+        LARGE_INTEGER due{};
+        due.QuadPart = -static_cast<LONGLONG>(kRescanDebounceMs) * 10000;  // Relative, 100 ns units
+        if (SetWaitableTimer(rescan_timer_, &due, 0, nullptr, nullptr, FALSE)) {
+            return;
+        }
+    }
+    rescan_pending_ = true;
+    if (wake_event_) {
+        SetEvent(wake_event_);
+    }
+}
+
+bool GammaWorker::pollResult(GammaResult& out)
+{
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    if (result_.sequence == polled_seq_) {
+        return false;
+    }
+    out = result_;
+    polled_seq_ = result_.sequence;
+    return true;
+}
+
+bool GammaWorker::pollAcceptedRamps(std::vector<AcceptedRampRecord>& out)
+{
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    if (accepted_version_ == polled_accepted_) {
+        return false;
+    }
+    out = accepted_ramps_;
+    polled_accepted_ = accepted_version_;
+    return true;
+}
+
+bool GammaWorker::pollTopology(MonitorTopology& out)
+{
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    if (topology_.generation == polled_topology_) {
+        return false;
+    }
+    out = topology_;
+    polled_topology_ = topology_.generation;
+    return true;
+}
+
+void GammaWorker::workerThread()
+{
+    while (running_) {
+        HANDLE handles[3] = { wake_event_ };
+        DWORD count = 1;
+        DWORD rescan_index = MAXDWORD;
+        if (rescan_timer_) {
+            rescan_index = count;
+            handles[count++] = rescan_timer_;
+        }
+        if (transition_.active && frame_timer_) {
+            handles[count++] = frame_timer_;
+        }
+        DWORD signaled = WaitForMultipleObjects(count, handles, FALSE, INFINITE);
+        if (!running_) break;
+
+        if (signaled == WAIT_OBJECT_0 + rescan_index || rescan_pending_.exchange(false)) {
+            rescanTopology();
+        }
+
+        // Take the newest request, if any. It supersedes a running
+        // transition.
+        if (requests_.update()) {
+            const GammaRequest& request = requests_.front();
+            if (request.transition_ms > 0.0 && frame_timer_) {
+                beginTransition(request);
+            } else {
+                endTransition();
+                process(request);
+            }
+            continue;
+        }
+
+        if (transition_.active) {
+            stepTransition();
+        }
+    }
+}
+
+void GammaWorker::beginTransition(const GammaRequest& request)
+{
+    endTransition();
+
+    const LONG period_ms = (std::max)(kFramePeriodMs,
+        static_cast<LONG>(request.transition_ms / static_cast<double>(kMaxTransitionFrames)));
+    size_t frame_count = static_cast<size_t>(request.transition_ms / period_ms);
+    GammaTransition frames;
+    gamma_->setWhitePoint(request.white_point_k);
+    gamma_->setVerifyPolicy(request.verify_policy);
+    if (frame_count > 1) {
+        // The last period lands on the target itself, via process()
+        frame_count -= 1;
+        if (request.kind == GammaRequest::Kind::Apply) {
+            frames = gamma_->prepareTransition(resolveTargets(request, request.monitors),
+                                               frame_count);
+        } else {
+            frames = gamma_->prepareRestoreTransition(frame_count);
+        }
+    }
+
+    if (frames.empty()) {
+        // Too short to animate, or nothing to animate from
+        process(request);
+        return;
+    }
+
+    transition_.active = true;
+    transition_.request = request;
+    transition_.frames = std::move(frames);
+    transition_.duration_ms = request.transition_ms;
+    transition_.next_frame = 0;
+    QueryPerformanceCounter(&transition_.start);
+
+    LARGE_INTEGER due{};
+    due.QuadPart = -static_cast<LONGLONG>(period_ms) * 10000;  // Relative, 100 ns units
+    SetWaitableTimer(frame_timer_, &due, period_ms, nullptr, nullptr, FALSE);
+}
+
+void GammaWorker::stepTransition()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    double elapsed_ms = 1000.0 * static_cast<double>(now.QuadPart - transition_.start.QuadPart) /
+                        static_cast<double>(qpc_frequency_.QuadPart);
+
+    const size_t frame_count = transition_.frames.frame_count;
+    if (elapsed_ms >= transition_.duration_ms) {
+        GammaRequest request = std::move(transition_.request);
+        endTransition();
+        process(request);
+        return;
+    }
+
+    // Show the frame for the current time. Frames that came due while the
+    // previous SetDeviceGammaRamp was still running are skipped.
+    size_t frame = static_cast<size_t>(std::floor(
+        elapsed_ms / transition_.duration_ms * static_cast<double>(frame_count + 1)));
+    if (frame == 0 || frame <= transition_.next_frame) {
+        return;
+    }
+    frame = (std::min)(frame, frame_count);
+    gamma_->applyTransitionFrame(transition_.frames, frame - 1);
+    transition_.next_frame = frame;
+}
+
+void GammaWorker::endTransition()
+{
+    if (!transition_.active) return;
+    CancelWaitableTimer(frame_timer_);
+    transition_ = ActiveTransition{};
+}
+
+void GammaWorker::process(const GammaRequest& request)
+{
+    const std::vector<CurvePoint>* custom =
+        (request.curve == ToneCurve::Custom) ? &request.custom_curve : nullptr;
+
+    gamma_->setWhitePoint(request.white_point_k);
+    gamma_->setVerifyPolicy(request.verify_policy);
+    last_request_ = request;
+    has_last_request_ = true;
+
+    bool success = false;
+    switch (request.kind) {
+    case GammaRequest::Kind::Apply:
+        // Monitors whose curve didn't change since the last apply are skipped
+        success = gamma_->applyEach(resolveTargets(request, request.monitors));
+        break;
+
+    case GammaRequest::Kind::Restore:
+        success = gamma_->restoreAll();
+        break;
+
+    case GammaRequest::Kind::Reset:
+        success = gamma_->restoreAll();
+        if (!success) {
+            gamma_->applyAll(request.curve, 1.0, custom, request.interpolation);
+        }
+        break;
+    }
+
+    publishAcceptedRamps();
+    {
+        std::lock_guard<std::mutex> lock(result_mutex_);
+        result_.sequence = request.sequence;
+        result_.kind = request.kind;
+        result_.success = success;
+        result_.report_status = request.report_status;
+        result_.monitor_apply_ms.clear();
+        if (request.kind == GammaRequest::Kind::Apply) {
+            for (size_t i = 0; i < gamma_->getMonitorCount(); ++i) {
+                result_.monitor_apply_ms.push_back(gamma_->getMonitor(i)->last_apply_ms);
+            }
+        }
+    }
+
+    completed_seq_.store(request.sequence, std::memory_order_release);
+    SetEvent(completion_event_);
+}
+
+void GammaWorker::rescanTopology()
+{
+    // A running fade holds monitor indices that are about to go stale, so
+    // it jumps to its verified final apply once the list is settled
+    bool interrupted = transition_.active;
+    GammaRequest pending;
+    if (interrupted) {
+        pending = std::move(transition_.request);
+        endTransition();
+    }
+
+    MonitorRefresh refresh = gamma_->refreshMonitors();
+    if (refresh.changed) {
+        publishTopology();
+    }
+
+    if (interrupted) {
+        process(pending);
+        return;
+    }
+
+    // Displays that stayed put and kept their ramp are left alone. Only a
+    // whole-desktop apply is carried over: per-display targets were
+    // indices into the old list, and restored outputs already show the
+    // original ramp.
+    if (refresh.reapply.empty() || !has_last_request_ ||
+        last_request_.kind != GammaRequest::Kind::Apply || !last_request_.monitors.empty()) {
+        return;
+    }
+    gamma_->applyEach(resolveTargets(last_request_, refresh.reapply));
+    publishAcceptedRamps();
+}
+
+std::vector<MonitorCurve> GammaWorker::resolveTargets(const GammaRequest& request,
+                                                      const std::vector<size_t>& indices) const
+{
+    std::vector<MonitorCurve> targets;
+    auto add = [&](size_t index) {
+        const MonitorInfo* monitor = gamma_->getMonitor(index);
+        if (!monitor) return;
+
+        MonitorCurve target;
+        target.monitor_index = index;
+        target.curve = request.curve;
+        target.strength = request.strength;
+        target.custom_curve = &request.custom_curve;
+        target.interpolation = request.interpolation;
+        for (const auto& profile : request.overrides) {
+            if (profile.monitor_id == monitor->device_id) {
+                target.curve = profile.curve;
+                target.strength = profile.strength;
+                target.custom_curve = &profile.custom_curve;
+                target.interpolation = profile.interpolation;
+                break;
+            }
+        }
+        if (target.curve != ToneCurve::Custom) {
+            target.custom_curve = nullptr;
+        }
+        targets.push_back(target);
+    };
+
+    if (indices.empty()) {
+        for (size_t i = 0; i < gamma_->getMonitorCount(); ++i) add(i);
+    } else {
+        for (size_t index : indices) add(index);
+    }
+    return targets;
+}
+
+void GammaWorker::publishAcceptedRamps()
+{
+    uint64_t generation = gamma_->getAcceptedRampGeneration();
+    if (generation == copied_accepted_generation_) return;
+    copied_accepted_generation_ = generation;
+
+    std::vector<AcceptedRampRecord> records = gamma_->getAcceptedRamps();
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    accepted_ramps_ = std::move(records);
+    accepted_version_ += 1;
+}
+
+void GammaWorker::publishTopology()
+{
+    {
+        std::lock_guard<std::mutex> lock(result_mutex_);
+        topology_.generation += 1;
+        topology_.handles.clear();
+        topology_.device_ids.clear();
+        for (size_t i = 0; i < gamma_->getMonitorCount(); ++i) {
+            topology_.handles.push_back(gamma_->getMonitor(i)->handle);
+            topology_.device_ids.push_back(gamma_->getMonitor(i)->device_id);
+        }
+        topology_.primary_index = gamma_->getPrimaryIndex();
+    }
+    if (completion_event_) {
+        SetEvent(completion_event_);
+    }
+}
+
+} // namespace lumos::platform
@@ -0,0 +1,207 @@
+// Lumos - Asynchronous gamma apply worker
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gamma.h"
+#include "triple_buffer.h"
+
+namespace lumos::platform {
+
+// A display with its own curve. Found by MonitorInfo::device_id, so it
+// follows the display across rescans and reordering.
+struct MonitorOverride {
+    std::wstring monitor_id;
+    ToneCurve curve = ToneCurve::Power;
+    double strength = 1.0;
+    std::vector<CurvePoint> custom_curve;  // Used when curve == Custom
+    CurveInterpolation interpolation = CurveInterpolation::Linear;
+};
+
+// A ramp operation requested by the UI thread
+struct GammaRequest {
+    enum class Kind {
+        Apply,    // Apply curve/strength to all monitors
+        Restore,  // Restore captured original ramps
+        Reset,    // Restore originals, fall back to curve at strength 1.0
+    };
+
+    Kind kind = Kind::Apply;
+    ToneCurve curve = ToneCurve::Power;
+    double strength = 1.0;
+    std::vector<CurvePoint> custom_curve;  // Used when curve == Custom
+    CurveInterpolation interpolation = CurveInterpolation::Linear;  // Custom only
+    double white_point_k = kNeutralWhitePointK;  // Per-channel tint for Apply/Reset
+    VerifyPolicy verify_policy = VerifyPolicy::Sampled;  // Readback checks for this and later applies
+    std::vector<size_t> monitors;          // Apply only: target monitors, empty = all
+    std::vector<MonitorOverride> overrides;  // Apply only: displays that don't take curve/strength
+    bool report_status = true;             // Whether the UI should report the outcome
+    double transition_ms = 0.0;            // Animate to the result over this long (0 = instant)
+    uint64_t sequence = 0;                 // Assigned by GammaWorker::post
+};
+
+// Outcome of the most recently completed request
+struct GammaResult {
+    uint64_t sequence = 0;
+    GammaRequest::Kind kind = GammaRequest::Kind::Apply;
+    bool success = false;
+    bool report_status = true;
+    std::vector<double> monitor_apply_ms;  // Per-monitor apply time (Apply only)
+};
+
+// Monitor list as last published by the worker. The worker owns Gamma's
+// monitor list, so the UI thread reads this copy instead.
+struct MonitorTopology {
+    uint64_t generation = 0;  // Bumped whenever the list changes
+    std::vector<HMONITOR> handles;
+    std::vector<std::wstring> device_ids;  // MonitorInfo::device_id, same order
+    size_t primary_index = 0;
+};
+
+// Runs Gamma operations on a dedicated thread so the UI never blocks on
+// SetDeviceGammaRamp or the adaptive verification readbacks.
+//
+// Requests go through a single-slot "latest wins" mailbox (a lock-free
+// triple buffer): posting replaces any request the worker has not picked up
+// yet, so intermediate slider values are dropped instead of queued.
+// post() must only be called from one thread (the UI thread).
+//
+// Requests with a transition_ms animate: the intermediate ramps are
+// precomputed when the request is picked up, then stepped by a periodic
+// high-resolution waitable timer. The frame shown is derived from elapsed
+// time, so a slow driver skips frames instead of stretching the fade, and
+// a newer request takes over from whatever ramp is on screen.
+//
+// Display changes are debounced on the worker as well: each notification
+// restarts a one-shot timer, and only when it fires are the monitors
+// re-enumerated and the last applied curve pushed to the outputs that need it.
+class GammaWorker {
+public:
+    GammaWorker() = default;
+    ~GammaWorker();
+
+    GammaWorker(const GammaWorker&) = delete;
+    GammaWorker& operator=(const GammaWorker&) = delete;
+
+    // Start/stop the worker thread. stop() finishes the request in flight
+    // and drops anything still pending.
+    bool start(Gamma& gamma);
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // Post a request (UI thread only). Returns its sequence number.
+    uint64_t post(GammaRequest request);
+
+    // Re-enumerate displays once change notifications have been quiet for
+    // kRescanDebounceMs. Each call restarts the wait, so a burst of
+    // WM_DISPLAYCHANGE / WM_DEVICECHANGE messages costs one rescan.
+    void requestTopologyRescan();
+
+    // Fetch the latest completed result. Returns false if nothing new
+    // completed since the previous call.
+    bool pollResult(GammaResult& out);
+
+    // Fetch the monitor list. Returns false if it is unchanged since the
+    // previous call; the completion event is signaled when it changes.
+    bool pollTopology(MonitorTopology& out);
+
+    // Fetch every monitor's accepted ramps (Gamma::getAcceptedRamps) for
+    // the curve library. Returns false if unchanged since the previous
+    // call; they only change when a monitor is probed.
+    bool pollAcceptedRamps(std::vector<AcceptedRampRecord>& out);
+
+    // True when every posted request has been applied
+    bool isIdle() const { return completed_seq_.load() == posted_seq_.load(); }
+
+    // Auto-reset event signaled whenever a request completes
+    HANDLE completionEvent() const { return completion_event_; }
+
+private:
+    void workerThread();
+    void process(const GammaRequest& request);
+
+    // Per-monitor curves for an Apply (indices empty = all monitors),
+    // pointing into request
+    std::vector<MonitorCurve> resolveTargets(const GammaRequest& request,
+                                             const std::vector<size_t>& indices) const;
+
+    // Diff the monitor list after a display change and bring changed
+    // outputs up to the last applied request (worker thread only)
+    void rescanTopology();
+    void publishTopology();
+    void publishAcceptedRamps();
+
+    // Animated transitions (worker thread only)
+    void beginTransition(const GammaRequest& request);
+    void stepTransition();
+    void endTransition();
+
+    // Request mailbox: the UI thread produces, the worker consumes
+    TripleBuffer<GammaRequest> requests_;
+
+    std::atomic<uint64_t> posted_seq_{0};
+    std::atomic<uint64_t> completed_seq_{0};
+
+    // Latest completed result (written once per apply, so a plain mutex)
+    std::mutex result_mutex_;
+    GammaResult result_;
+    uint64_t polled_seq_ = 0;
+    MonitorTopology topology_;
+    uint64_t polled_topology_ = 0;
+    std::vector<AcceptedRampRecord> accepted_ramps_;
+    uint64_t accepted_version_ = 0;
+    uint64_t polled_accepted_ = 0;
+    uint64_t copied_accepted_generation_ = 0;  // Worker thread only
+
+    // Last request processed, reapplied to displays that appear or reset
+    GammaRequest last_request_;
+    bool has_last_request_ = false;
+
+    Gamma* gamma_ = nullptr;
+    std::thread worker_thread_;
+    std::atomic<bool> running_{false};
+    HANDLE wake_event_ = nullptr;
+    HANDLE completion_event_ = nullptr;
+
+    // Display change debounce (one-shot, re-armed by every notification).
+    // Without a timer the rescan runs on the next wake instead.
+    static constexpr LONG kRescanDebounceMs = 500;
+    HANDLE rescan_timer_ = nullptr;
+    std::atomic<bool> rescan_pending_{false};
+
+    // Transition in progress. The request is copied out of its slot since
+    // the slot goes back to the producer on the next swap.
+    // Long fades (scheduled changes) step less often rather than holding
+    // more than kMaxTransitionFrames precomputed ramps per monitor
+    static constexpr LONG kFramePeriodMs = 16;
+    static constexpr size_t kMaxTransitionFrames = 240;
+    struct ActiveTransition {
+        bool active = false;
+        GammaRequest request;        // Applied with verification when the fade ends
+        GammaTransition frames;
+        LARGE_INTEGER start{};
+        double duration_ms = 0.0;
+        size_t next_frame = 0;       // Frames below this were shown or skipped
+    };
+    ActiveTransition transition_;
+    HANDLE frame_timer_ = nullptr;
+    LARGE_INTEGER qpc_frequency_{};
+};
+
+} // namespace lumos::platform
@@ -0,0 +1,76 @@
+// Lumos - Single-instance command channel
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#include "instance_channel.h"
+
+namespace lumos::platform {
+
+namespace {
+
+// Per-session, so each logged-on user (or RDP session) gets their own instance
+constexpr wchar_t kInstanceMutexName[] = L"Local\\Lumos.Instance";
+
+// COPYDATASTRUCT::dwData tag identifying a Lumos command (format version 1)
+constexpr ULONG_PTR kCommandTag = 0x4C4D0001;
+
+} // anonymous namespace
+
+InstanceLock::~InstanceLock()
+{
+    if (mutex_) {
+        CloseHandle(mutex_);
+    }
+}
+
+bool InstanceLock::acquire()
+{
+    if (mutex_) return true;
+
+    mutex_ = CreateMutexW(nullptr, FALSE, kInstanceMutexName);
+    if (mutex_ && GetLastError() == ERROR_ALREADY_EXISTS) {
+        CloseHandle(mutex_);
+        mutex_ = nullptr;
+        return false;
+    }
+    // If the mutex can't be created at all, run anyway
+    return true;
+}
+
+HWND findRunningInstance()
+{
+    return FindWindowW(kWindowClassName, nullptr);
+}
+
+std::optional<CommandReply> sendCommand(HWND target, const std::string& payload, DWORD timeout_ms)
+{
+    COPYDATASTRUCT data = {};
+    data.dwData = kCommandTag;
+    data.cbData = static_cast<DWORD>(payload.size());
+    data.lpData = const_cast<char*>(payload.data());
+
+    DWORD_PTR reply = 0;
+    LRESULT sent = SendMessageTimeoutW(target, WM_COPYDATA, 0, reinterpret_cast<LPARAM>(&data),
+                                       SMTO_ABORTIFHUNG | SMTO_BLOCK, timeout_ms, &reply);
+    if (!sent) {
+        return std::nullopt;
+    }
+
+    switch (static_cast<LRESULT>(reply)) {
+    case static_cast<LRESULT>(CommandReply::Accepted): return CommandReply::Accepted;
+    case static_cast<LRESULT>(CommandReply::Rejected): return CommandReply::Rejected;
+    default:                                           return std::nullopt;  // Not a Lumos window
+    }
+}
+
+bool readCommand(LPARAM lparam, std::string& payload)
+{
+    const auto* data = reinterpret_cast<const COPYDATASTRUCT*>(lparam);
+    if (!data || data->dwData != kCommandTag) {
+        return false;
+    }
+    payload.assign(static_cast<const char*>(data->lpData), data->cbData);
+    return true;
+}
+
+} // namespace lumos::platform
@@ -0,0 +1,52 @@
+// Lumos - Single-instance command channel
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <windows.h>
+#include <optional>
+#include <string>
+
+namespace lumos::platform {
+
+// Window class of the GUI instance; also how other processes find it
+constexpr wchar_t kWindowClassName[] = L"LumosWindowClass";
+
+// Replies from the running instance to a forwarded command
+enum class CommandReply : LRESULT {
+    Accepted = 1,  // Queued on the running instance's apply worker
+    Rejected = 2,  // Understood but invalid (bad display, unreadable curve file)
+};
+
+// Named mutex held by the GUI instance for its lifetime
+class InstanceLock {
+public:
+    InstanceLock() = default;
+    ~InstanceLock();
+
+    InstanceLock(const InstanceLock&) = delete;
+    InstanceLock& operator=(const InstanceLock&) = delete;
+
+    // Returns false if another GUI instance already holds the lock
+    bool acquire();
+
+private:
+    HANDLE mutex_ = nullptr;
+};
+
+// Window of the running GUI instance (hidden windows included), or nullptr
+HWND findRunningInstance();
+
+// Send a command via WM_COPYDATA and wait for the reply. Returns nullopt if
+// it couldn't be delivered within timeout_ms (instance hung or exiting).
+std::optional<CommandReply> sendCommand(HWND target, const std::string& payload, DWORD timeout_ms);
+
+// Extract the payload of a Lumos WM_COPYDATA message (false if it isn't one)
+bool readCommand(LPARAM lparam, std::string& payload);
+
+} // namespace lumos::platform
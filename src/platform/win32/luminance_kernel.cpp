@@ -0,0 +1,238 @@
+// Lumos - Luminance histogram kernels
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#include "luminance_kernel.h"
+#include <immintrin.h>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// MSVC accepts any intrinsic without /arch; GCC/Clang need per-function targets
+#if defined(__GNUC__)
+#define LUMOS_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define LUMOS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LUMOS_TARGET_SSE41
+#define LUMOS_TARGET_AVX2
+#endif
+
+namespace lumos::platform {
+
+namespace {
+
+// Pixels are spread over several sub-histograms so runs of identical
+// values (flat UI, solid backgrounds) don't serialize on one counter's
+// store-to-load dependency
+constexpr int kSubHistograms = 4;
+using SubHistograms = std::array<std::array<uint32_t, 256>, kSubHistograms>;
+
+void mergeSubHistograms(const SubHistograms& sub, LuminanceHistogram& histogram)
+{
+    for (int i = 0; i < 256; ++i) {
+        histogram[i] += sub[0][i] + sub[1][i] + sub[2][i] + sub[3][i];
+    }
+}
+
+inline void accumulateTail(const uint8_t* row, int begin, int end, SubHistograms& sub)
+{
+    for (int x = begin; x < end; ++x) {
+        const uint8_t* px = row + x * 4;
+        sub[x & (kSubHistograms - 1)][lumaFromRgb(px[2], px[1], px[0])]++;
+    }
+}
+
+} // anonymous namespace
+
+void accumulateLuminanceScalar(const uint8_t* pixels, int width, int height, int row_pitch,
+                               LuminanceHistogram& histogram)
+{
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * row_pitch;
+        for (int x = 0; x < width; ++x) {
+            // BGRA order
+            histogram[lumaFromRgb(row[x * 4 + 2], row[x * 4 + 1], row[x * 4 + 0])]++;
+        }
+    }
+}
+
+LUMOS_TARGET_SSE41
+void accumulateLuminanceSse41(const uint8_t* pixels, int width, int height, int row_pitch,
+                              LuminanceHistogram& histogram)
+{
+    SubHistograms sub{};
+
+    // Two BGRA pixels per 8 x 16-bit lanes; madd yields (B*wb + G*wg, R*wr)
+    // per pixel and hadd folds the pair
+    const __m128i weights = _mm_setr_epi16(kLumaWeightB, kLumaWeightG, kLumaWeightR, 0,
+                                           kLumaWeightB, kLumaWeightG, kLumaWeightR, 0);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * row_pitch;
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 4));
+            __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), weights);
+            __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), weights);
+            __m128i luma = _mm_srli_epi32(_mm_hadd_epi32(lo, hi), kLumaShift);
+
+            sub[0][_mm_cvtsi128_si32(luma)]++;
+            sub[1][_mm_extract_epi32(luma, 1)]++;
+            sub[2][_mm_extract_epi32(luma, 2)]++;
+            sub[3][_mm_extract_epi32(luma, 3)]++;
+        }
+        accumulateTail(row, x, width, sub);
+    }
+
+    mergeSubHistograms(sub, histogram);
+}
+
+LUMOS_TARGET_AVX2
+void accumulateLuminanceAvx2(const uint8_t* pixels, int width, int height, int row_pitch,
+                             LuminanceHistogram& histogram)
+{
+    SubHistograms sub{};
+
+    // Same scheme as SSE4.1 on 8 pixels; unpack/madd/hadd all stay within
+    // 128-bit lanes, so the result is pixels 0-3 then 4-7
+    const __m256i weights = _mm256_setr_epi16(
+        kLumaWeightB, kLumaWeightG, kLumaWeightR, 0, kLumaWeightB, kLumaWeightG, kLumaWeightR, 0,
+        kLumaWeightB, kLumaWeightG, kLumaWeightR, 0, kLumaWeightB, kLumaWeightG, kLumaWeightR, 0);
+    const __m256i zero = _mm256_setzero_si256();
+    alignas(32) uint32_t luma[8];
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * row_pitch;
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x * 4));
+            __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(px, zero), weights);
+            __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(px, zero), weights);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(luma),
+                               _mm256_srli_epi32(_mm256_hadd_epi32(lo, hi), kLumaShift));
+
+            sub[0][luma[0]]++;
+            sub[1][luma[1]]++;
+            sub[2][luma[2]]++;
+            sub[3][luma[3]]++;
+            sub[0][luma[4]]++;
+            sub[1][luma[5]]++;
+            sub[2][luma[6]]++;
+            sub[3][luma[7]]++;
+        }
+        accumulateTail(row, x, width, sub);
+    }
+
+    mergeSubHistograms(sub, histogram);
+}
+
+LuminanceKernel detectLuminanceKernel()
+{
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    bool ssse3 = (info[2] & (1 << 9)) != 0;
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+
+    // AVX state must also be enabled by the OS (XMM and YMM in XCR0)
+    bool avx2 = false;
+    if (avx && osxsave && (_xgetbv(0) & 0x6) == 0x6 && max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    bool ssse3 = __builtin_cpu_supports("ssse3");
+    bool sse41 = __builtin_cpu_supports("sse4.1");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    if (avx2) return LuminanceKernel::Avx2;
+    if (sse41 && ssse3) return LuminanceKernel::Sse41;
+    return LuminanceKernel::Scalar;
+}
+
+namespace {
+
+using KernelFn = void (*)(const uint8_t*, int, int, int, LuminanceHistogram&);
+
+KernelFn kernelFunction(LuminanceKernel kernel)
+{
+    switch (kernel) {
+    case LuminanceKernel::Avx2:  return accumulateLuminanceAvx2;
+    case LuminanceKernel::Sse41: return accumulateLuminanceSse41;
+    default:                     return accumulateLuminanceScalar;
+    }
+}
+
+// Run the kernel on every (r, g, b) edge case plus a ramp, with an odd
+// width and padded pitch so the scalar tail is exercised too
+bool matchesReference(LuminanceKernel kernel)
+{
+    constexpr int kWidth = 67;
+    constexpr int kHeight = 64;
+    constexpr int kPitch = kWidth * 4 + 12;
+
+    std::vector<uint8_t> image(static_cast<size_t>(kPitch) * kHeight, 0);
+    uint32_t state = 0x9E3779B9u;
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            uint8_t* px = &image[static_cast<size_t>(y) * kPitch + x * 4];
+            state = state * 1664525u + 1013904223u;  // LCG
+            int i = y * kWidth + x;
+            bool extreme = (i % 7) == 0;
+            px[0] = extreme ? ((i & 1) ? 255 : 0) : static_cast<uint8_t>(state >> 24);
+            px[1] = extreme ? ((i & 2) ? 255 : 0) : static_cast<uint8_t>(state >> 16);
+            px[2] = extreme ? ((i & 4) ? 255 : 0) : static_cast<uint8_t>(state >> 8);
+            px[3] = static_cast<uint8_t>(state);
+        }
+    }
+
+    LuminanceHistogram expected{};
+    LuminanceHistogram actual{};
+    accumulateLuminanceScalar(image.data(), kWidth, kHeight, kPitch, expected);
+    kernelFunction(kernel)(image.data(), kWidth, kHeight, kPitch, actual);
+    return expected == actual;
+}
+
+LuminanceKernel selectKernel()
+{
+    LuminanceKernel kernel = detectLuminanceKernel();
+    if (kernel != LuminanceKernel::Scalar && !matchesReference(kernel)) {
+        kernel = LuminanceKernel::Scalar;
+    }
+    return kernel;
+}
+
+} // anonymous namespace
+
+LuminanceKernel activeLuminanceKernel()
+{
+    static const LuminanceKernel kernel = selectKernel();
+    return kernel;
+}
+
+void accumulateLuminance(const uint8_t* pixels, int width, int height, int row_pitch,
+                         LuminanceHistogram& histogram)
+{
+    static const KernelFn kernel = kernelFunction(activeLuminanceKernel());
+    kernel(pixels, width, height, row_pitch, histogram);
+}
+
+const char* luminanceKernelName(LuminanceKernel kernel)
+{
+    switch (kernel) {
+    case LuminanceKernel::Avx2:  return "AVX2";
+    case LuminanceKernel::Sse41: return "SSE4.1";
+    default:                     return "Scalar";
+    }
+}
+
+} // namespace lumos::platform
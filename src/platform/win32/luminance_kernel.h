@@ -0,0 +1,56 @@
+// Lumos - Luminance histogram kernels
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace lumos::platform {
+
+// Rec. 709 luma weights in 15-bit fixed point (they sum to 1 << kLumaShift,
+// so a white pixel maps to exactly 255 and no clamp is needed)
+constexpr int kLumaShift = 15;
+constexpr int kLumaWeightR = 6966;   // 0.2126
+constexpr int kLumaWeightG = 23436;  // 0.7152
+constexpr int kLumaWeightB = 2366;   // 0.0722
+static_assert(kLumaWeightR + kLumaWeightG + kLumaWeightB == (1 << kLumaShift));
+
+constexpr uint32_t lumaFromRgb(uint32_t r, uint32_t g, uint32_t b)
+{
+    return (kLumaWeightR * r + kLumaWeightG * g + kLumaWeightB * b) >> kLumaShift;
+}
+
+using LuminanceHistogram = std::array<uint32_t, 256>;
+
+enum class LuminanceKernel {
+    Scalar,
+    Sse41,
+    Avx2,
+};
+
+// Add the luminance of every pixel of a 32-bit BGRA image to histogram.
+// Dispatches to the fastest kernel the CPU supports.
+void accumulateLuminance(const uint8_t* pixels, int width, int height, int row_pitch,
+                         LuminanceHistogram& histogram);
+
+// Individual kernels. All produce identical results; the scalar one is the
+// reference the SIMD kernels are checked against.
+void accumulateLuminanceScalar(const uint8_t* pixels, int width, int height, int row_pitch,
+                               LuminanceHistogram& histogram);
+void accumulateLuminanceSse41(const uint8_t* pixels, int width, int height, int row_pitch,
+                              LuminanceHistogram& histogram);
+void accumulateLuminanceAvx2(const uint8_t* pixels, int width, int height, int row_pitch,
+                             LuminanceHistogram& histogram);
+
+// Best kernel supported by this CPU/OS
+LuminanceKernel detectLuminanceKernel();
+
+// Kernel used by accumulateLuminance (detected once, verified against the
+// scalar reference, falls back to scalar on mismatch)
+LuminanceKernel activeLuminanceKernel();
+
+const char* luminanceKernelName(LuminanceKernel kernel);
+
+} // namespace lumos::platform
@@ -0,0 +1,175 @@
+// Lumos - Hot-path instrumentation
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include "perf_trace.h"
+#include <windows.h>
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <vector>
+
+namespace lumos::platform {
+
+namespace {
+
+// Fields are written independently, so a reader racing a writer can see a
+// start from one sample and a duration from the next. Good enough for
+// percentiles; not worth a lock on the apply path.
+struct PerfSlot {
+    std::atomic<int64_t> start{0};
+    std::atomic<int64_t> duration{0};
+    std::atomic<uint32_t> thread{0};
+};
+
+struct PerfRing {
+    std::atomic<uint64_t> head{0};
+    std::array<PerfSlot, kPerfRingSize> slots;
+};
+
+std::array<PerfRing, kPerfStageCount> g_rings;
+
+int64_t qpcFrequency()
+{
+    static const int64_t frequency = [] {
+        LARGE_INTEGER freq;
+        QueryPerformanceFrequency(&freq);
+        return static_cast<int64_t>(freq.QuadPart);
+    }();
+    return frequency;
+}
+
+// Sorted durations (in ticks) currently in a ring
+std::vector<int64_t> snapshotDurations(const PerfRing& ring)
+{
+    size_t count = static_cast<size_t>(
+        (std::min)(ring.head.load(std::memory_order_acquire), static_cast<uint64_t>(kPerfRingSize)));
+    std::vector<int64_t> durations;
+    durations.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        durations.push_back(ring.slots[i].duration.load(std::memory_order_relaxed));
+    }
+    std::sort(durations.begin(), durations.end());
+    return durations;
+}
+
+} // anonymous namespace
+
+const char* perfStageName(PerfStage stage)
+{
+    switch (stage) {
+        case PerfStage::BuildRamp: return "Build ramp";
+        case PerfStage::SetRamp: return "Set ramp";
+        case PerfStage::VerifyRamp: return "Verify ramp";
+        case PerfStage::HistogramCapture: return "Histogram";
+        case PerfStage::UiFrame: return "UI frame";
+        case PerfStage::Present: return "Present";
+        default: return "Unknown";
+    }
+}
+
+void setPerfTracingEnabled(bool enabled)
+{
+    detail::g_perf_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+int64_t perfNow()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return static_cast<int64_t>(now.QuadPart);
+}
+
+void recordPerfSample(PerfStage stage, int64_t start_ticks, int64_t end_ticks)
+{
+    PerfRing& ring = g_rings[static_cast<size_t>(stage)];
+    uint64_t index = ring.head.fetch_add(1, std::memory_order_acq_rel) % kPerfRingSize;
+    PerfSlot& slot = ring.slots[index];
+    slot.start.store(start_ticks, std::memory_order_relaxed);
+    slot.duration.store(end_ticks - start_ticks, std::memory_order_relaxed);
+    slot.thread.store(GetCurrentThreadId(), std::memory_order_relaxed);
+}
+
+PerfStageStats getPerfStats(PerfStage stage)
+{
+    std::vector<int64_t> durations = snapshotDurations(g_rings[static_cast<size_t>(stage)]);
+    PerfStageStats stats;
+    stats.count = durations.size();
+    if (durations.empty()) return stats;
+
+    const double ms_per_tick = 1000.0 / static_cast<double>(qpcFrequency());
+    auto percentile = [&](double p) {
+        size_t index = static_cast<size_t>(p * static_cast<double>(durations.size() - 1) + 0.5);
+        return static_cast<double>(durations[index]) * ms_per_tick;
+    };
+    stats.p50_ms = percentile(0.50);
+    stats.p99_ms = percentile(0.99);
+    stats.max_ms = static_cast<double>(durations.back()) * ms_per_tick;
+    return stats;
+}
+
+void clearPerfSamples()
+{
+    for (PerfRing& ring : g_rings) {
+        ring.head.store(0, std::memory_order_release);
+        for (PerfSlot& slot : ring.slots) {
+            slot.duration.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool exportPerfTrace(const std::filesystem::path& path)
+{
+    struct Event {
+        PerfStage stage;
+        int64_t start;
+        int64_t duration;
+        uint32_t thread;
+    };
+    std::vector<Event> events;
+    for (size_t s = 0; s < kPerfStageCount; ++s) {
+        const PerfRing& ring = g_rings[s];
+        size_t count = static_cast<size_t>(
+            (std::min)(ring.head.load(std::memory_order_acquire), static_cast<uint64_t>(kPerfRingSize)));
+        for (size_t i = 0; i < count; ++i) {
+            const PerfSlot& slot = ring.slots[i];
+            events.push_back({static_cast<PerfStage>(s), slot.start.load(std::memory_order_relaxed),
+                              slot.duration.load(std::memory_order_relaxed),
+                              slot.thread.load(std::memory_order_relaxed)});
+        }
+    }
+    std::sort(events.begin(), events.end(),
+              [](const Event& a, const Event& b) { return a.start < b.start; });
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    // Timestamps in microseconds from the first sample
+    const double us_per_tick = 1e6 / static_cast<double>(qpcFrequency());
+    const int64_t origin = events.empty() ? 0 : events.front().start;
+    const DWORD pid = GetCurrentProcessId();
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        file << "{\"name\":\"" << perfStageName(e.stage) << "\",\"cat\":\"lumos\",\"ph\":\"X\""
+             << ",\"ts\":" << static_cast<double>(e.start - origin) * us_per_tick
+             << ",\"dur\":" << static_cast<double>(e.duration) * us_per_tick
+             << ",\"pid\":" << pid << ",\"tid\":" << e.thread << "}"
+             << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+    return file.good();
+}
+
+} // namespace lumos::platform
@@ -0,0 +1,85 @@
+// Lumos - Hot-path instrumentation
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+// Scoped QPC timers for the paths that make the slider feel slow. Samples
+// go into a fixed ring per stage; while tracing is off a PerfScope is one
+// relaxed atomic load and nothing else.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace lumos::platform {
+
+enum class PerfStage {
+    BuildRamp,         // Gamma: curve -> ideal ramp (cache misses only)
+    SetRamp,           // Gamma: SetDeviceGammaRamp
+    VerifyRamp,        // Gamma: GetDeviceGammaRamp readback + compare
+    HistogramCapture,  // ScreenHistogramCapture: one sample of one output
+    UiFrame,           // WinMain: ImGui frame build and draw submission
+    Present,           // WinMain: swap chain Present (includes vsync wait)
+};
+
+constexpr size_t kPerfStageCount = 6;
+
+// Samples kept per stage (older ones are overwritten)
+constexpr size_t kPerfRingSize = 1024;
+
+const char* perfStageName(PerfStage stage);
+
+struct PerfStageStats {
+    size_t count = 0;  // Samples in the ring
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+namespace detail {
+inline std::atomic<bool> g_perf_enabled{false};
+}
+
+inline bool isPerfTracingEnabled()
+{
+    return detail::g_perf_enabled.load(std::memory_order_relaxed);
+}
+
+void setPerfTracingEnabled(bool enabled);
+
+// Current QPC tick count
+int64_t perfNow();
+
+// Add a sample (any thread)
+void recordPerfSample(PerfStage stage, int64_t start_ticks, int64_t end_ticks);
+
+// Percentiles over the samples currently in the ring
+PerfStageStats getPerfStats(PerfStage stage);
+
+void clearPerfSamples();
+
+// Write every sample as a Chrome trace-event JSON file (opens in Perfetto
+// or chrome://tracing)
+bool exportPerfTrace(const std::filesystem::path& path);
+
+// Times its own lifetime into stage when tracing is on
+class PerfScope {
+public:
+    explicit PerfScope(PerfStage stage)
+        : stage_(stage), start_(isPerfTracingEnabled() ? perfNow() : 0) {}
+    ~PerfScope()
+    {
+        if (start_ != 0) recordPerfSample(stage_, start_, perfNow());
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfStage stage_;
+    int64_t start_;
+};
+
+} // namespace lumos::platform
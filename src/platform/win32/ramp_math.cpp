@@ -0,0 +1,243 @@
+// Lumos - Gamma ramp math
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#include "ramp_math.h"
+#include "tone_curve.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace lumos::platform {
+
+GammaRamp buildIdentityRamp()
+{
+    GammaRamp ramp{};
+    for (int i = 0; i < 256; ++i) {
+        uint16_t val = static_cast<uint16_t>(i * 257);  // Maps 0-255 to 0-65535
+        ramp.red[i] = val;
+        ramp.green[i] = val;
+        ramp.blue[i] = val;
+    }
+    return ramp;
+}
+
+GammaRamp blendRampTowardIdentity(const GammaRamp& ramp, const GammaRamp& identity,
+                                  double scale)
+{
+    GammaRamp result{};
+    for (int i = 0; i < 256; ++i) {
+        // Blend: identity + scale * (ramp - identity)
+        // When scale=1.0, result=ramp. When scale=0.0, result=identity.
+        double r = identity.red[i] + scale * (static_cast<double>(ramp.red[i]) - identity.red[i]);
+        double g = identity.green[i] + scale * (static_cast<double>(ramp.green[i]) - identity.green[i]);
+        double b = identity.blue[i] + scale * (static_cast<double>(ramp.blue[i]) - identity.blue[i]);
+
+        result.red[i] = static_cast<uint16_t>(std::lround(std::clamp(r, 0.0, 65535.0)));
+        result.green[i] = static_cast<uint16_t>(std::lround(std::clamp(g, 0.0, 65535.0)));
+        result.blue[i] = static_cast<uint16_t>(std::lround(std::clamp(b, 0.0, 65535.0)));
+    }
+    return result;
+}
+
+void enforceMonotonicity(GammaRamp& ramp)
+{
+    // Ensure ramp values are strictly increasing (or at least non-decreasing).
+    // Windows heuristics reject ramps with flat or decreasing segments.
+    // We enforce a minimum step of 1 to keep it strictly increasing.
+    constexpr uint16_t kMinStep = 1;
+
+    auto enforce_channel = [](std::array<uint16_t, 256>& channel) {
+        uint16_t prev = 0;
+        for (int i = 0; i < 256; ++i) {
+            if (channel[i] <= prev && i > 0) {
+                channel[i] = (prev < 65535 - kMinStep) ? prev + kMinStep : 65535;
+            }
+            prev = channel[i];
+        }
+    };
+
+    enforce_channel(ramp.red);
+    enforce_channel(ramp.green);
+    enforce_channel(ramp.blue);
+}
+
+GammaRamp buildRamp(ToneCurve curve, double strength,
+                    const std::vector<CurvePoint>* custom_curve,
+                    CurveInterpolation interpolation,
+                    double white_point_k)
+{
+    if (strength < 0.1) strength = 0.1;
+    if (strength > 9.0) strength = 9.0;
+
+    // Fixed presets come straight from their compile-time tables, custom
+    // curves are compiled once and swept
+    CurveTable curve_values;
+    evaluateCurve(curve, strength, custom_curve, interpolation, curve_values);
+    const ChannelGains gains = whitePointGains(white_point_k);
+
+    auto to_word = [](double value) {
+        return static_cast<uint16_t>(std::clamp(std::lround(value * 65535.0), 0L, 65535L));
+    };
+
+    GammaRamp ramp{};
+    for (int i = 0; i < 256; ++i) {
+        double linear = i / 255.0;
+        double corrected = curve_values[i];
+
+        // Clamp to valid range [0, 1]
+        // Note: We use expanded bounds here. The adaptive application layer
+        // (searchRampScale) will scale back toward identity if Windows
+        // rejects the ramp. This allows us to request aggressive curves and
+        // get the maximum the driver will accept.
+        if (corrected < 0.0) corrected = 0.0;
+        if (corrected > 1.0) corrected = 1.0;
+
+        // Optional soft bounds: keep values within a generous envelope around
+        // identity to increase likelihood of acceptance.
+        // Allow crushing blacks (min=0) and generous shadow lift (offset 0.2)
+        double identity_val = linear;
+        double min_allowed = 0.0;
+        double max_allowed = (std::min)(1.0, identity_val * 3.0 + 0.2);
+        if (corrected < min_allowed) corrected = min_allowed;
+        if (corrected > max_allowed) corrected = max_allowed;
+
+        ramp.red[i] = to_word(corrected * gains.red);
+        ramp.green[i] = to_word(corrected * gains.green);
+        ramp.blue[i] = to_word(corrected * gains.blue);
+    }
+
+    // Enforce monotonicity to help pass Windows heuristics
+    enforceMonotonicity(ramp);
+
+    return ramp;
+}
+
+namespace {
+
+// Largest channel deviation from identity at level i
+int32_t rampDeviation(const GammaRamp& ramp, size_t i)
+{
+    const int32_t identity = static_cast<int32_t>(i * 257);
+    return (std::max)({std::abs(ramp.red[i] - identity), std::abs(ramp.green[i] - identity),
+                       std::abs(ramp.blue[i] - identity)});
+}
+
+} // anonymous namespace
+
+void learnAcceptedRamp(RampEnvelope& envelope, const GammaRamp& ramp)
+{
+    // Verification allows kRampMatchTolerance of rounding, so a rejected
+    // ramp close to the previous one can pass; whatever is actually applied
+    // is within that distance, which is what's proven safe
+    for (size_t i = 0; i < 256; ++i) {
+        int32_t deviation = rampDeviation(ramp, i) - kRampMatchTolerance;
+        envelope.safe[i] = (std::max)(envelope.safe[i], deviation);
+        if (envelope.limit[i] <= envelope.safe[i]) {
+            // Marked by a rejection we now know wasn't this level's fault
+            envelope.limit[i] = RampEnvelope::kUnknown;
+        }
+    }
+    envelope.learned = true;
+}
+
+void learnRejectedRamp(RampEnvelope& envelope, const GammaRamp& ramp)
+{
+    for (size_t i = 0; i < 256; ++i) {
+        int32_t deviation = rampDeviation(ramp, i);
+        if (deviation > envelope.safe[i]) {
+            envelope.limit[i] = (std::min)(envelope.limit[i], deviation);
+        }
+    }
+    envelope.learned = true;
+}
+
+GammaRamp projectOntoEnvelope(const GammaRamp& ideal, const RampEnvelope& envelope, bool probe)
+{
+    GammaRamp result = ideal;
+    for (size_t i = 0; i < 256; ++i) {
+        const int32_t safe = envelope.safe[i];
+        const int32_t limit = envelope.limit[i];
+        if (limit == RampEnvelope::kUnknown) continue;
+
+        int32_t bound = (probe && limit - safe > kEnvelopeResolution) ? (safe + limit) / 2 : safe;
+        const int32_t identity = static_cast<int32_t>(i * 257);
+        auto clamp_channel = [&](uint16_t& value) {
+            value = static_cast<uint16_t>(std::clamp(static_cast<int32_t>(value),
+                                                     (std::max)(0, identity - bound),
+                                                     (std::min)(65535, identity + bound)));
+        };
+        clamp_channel(result.red[i]);
+        clamp_channel(result.green[i]);
+        clamp_channel(result.blue[i]);
+    }
+    enforceMonotonicity(result);
+    return result;
+}
+
+double effectiveRampScale(const GammaRamp& ideal, const GammaRamp& accepted)
+{
+    int32_t ideal_peak = 0;
+    int32_t accepted_peak = 0;
+    for (size_t i = 0; i < 256; ++i) {
+        ideal_peak = (std::max)(ideal_peak, rampDeviation(ideal, i));
+        accepted_peak = (std::max)(accepted_peak, rampDeviation(accepted, i));
+    }
+    if (ideal_peak == 0) return 1.0;
+    return std::clamp(static_cast<double>(accepted_peak) / ideal_peak, 0.0, 1.0);
+}
+
+bool rampsMatch(const GammaRamp& expected, const GammaRamp& actual, int tolerance)
+{
+    for (int i = 0; i < 256; ++i) {
+        int diff_r = std::abs(static_cast<int>(expected.red[i]) - static_cast<int>(actual.red[i]));
+        int diff_g = std::abs(static_cast<int>(expected.green[i]) - static_cast<int>(actual.green[i]));
+        int diff_b = std::abs(static_cast<int>(expected.blue[i]) - static_cast<int>(actual.blue[i]));
+
+        if (diff_r > tolerance || diff_g > tolerance || diff_b > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool rampsMatchSampled(const GammaRamp& expected, const GammaRamp& actual, int tolerance)
+{
+    for (size_t k = 0; k < kRampSampleCount; ++k) {
+        size_t i = k * 255 / (kRampSampleCount - 1);
+        int diff_r = std::abs(static_cast<int>(expected.red[i]) - static_cast<int>(actual.red[i]));
+        int diff_g = std::abs(static_cast<int>(expected.green[i]) - static_cast<int>(actual.green[i]));
+        int diff_b = std::abs(static_cast<int>(expected.blue[i]) - static_cast<int>(actual.blue[i]));
+
+        if (diff_r > tolerance || diff_g > tolerance || diff_b > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void buildTransitionFrames(const GammaRamp& from, const GammaRamp& to,
+                           size_t frame_count, std::vector<GammaRamp>& frames)
+{
+    frames.resize(frame_count);
+    for (size_t f = 0; f < frame_count; ++f) {
+        // Smoothstep easing, so the change starts and lands gently
+        double t = static_cast<double>(f + 1) / static_cast<double>(frame_count + 1);
+        t = t * t * (3.0 - 2.0 * t);
+
+        auto lerp = [t](uint16_t a, uint16_t b) {
+            double v = a + t * (static_cast<double>(b) - static_cast<double>(a));
+            return static_cast<uint16_t>(std::clamp(std::lround(v), 0L, 65535L));
+        };
+
+        GammaRamp& ramp = frames[f];
+        for (size_t i = 0; i < 256; ++i) {
+            ramp.red[i] = lerp(from.red[i], to.red[i]);
+            ramp.green[i] = lerp(from.green[i], to.green[i]);
+            ramp.blue[i] = lerp(from.blue[i], to.blue[i]);
+        }
+        enforceMonotonicity(ramp);
+    }
+}
+
+} // namespace lumos::platform
@@ -0,0 +1,222 @@
+// Lumos - Gamma ramp math
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+// Everything about building, blending and checking ramps that doesn't talk
+// to a device. Gamma wraps this with the Win32 set/read calls; lumos_bench
+// drives it directly.
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "gamma_types.h"
+
+namespace lumos::platform {
+
+// Largest per-entry difference between a requested ramp and its readback
+// that still counts as applied. SetDeviceGammaRamp can round values
+// slightly; a silently rejected ramp reads back very different (often the
+// previous ramp).
+constexpr int kRampMatchTolerance = 512;  // ~0.8% of 65535
+
+// Build identity ramp (linear 1:1 mapping)
+GammaRamp buildIdentityRamp();
+
+// Blend ramp toward identity by factor s (0=identity, 1=full ramp)
+GammaRamp blendRampTowardIdentity(const GammaRamp& ramp, const GammaRamp& identity,
+                                  double scale);
+
+// Enforce monotonicity: ensure ramp values are strictly increasing
+void enforceMonotonicity(GammaRamp& ramp);
+
+// Build all three channels in one pass: shared curve value, per-channel
+// white point gain, rounded (not truncated) to 16 bits
+GammaRamp buildRamp(ToneCurve curve, double strength,
+                    const std::vector<CurvePoint>* custom_curve = nullptr,
+                    CurveInterpolation interpolation = CurveInterpolation::Linear,
+                    double white_point_k = kNeutralWhitePointK);
+
+// Whether a readback matches the requested ramp within tolerance
+bool rampsMatch(const GammaRamp& expected, const GammaRamp& actual,
+                int tolerance = kRampMatchTolerance);
+
+// Entries compared by rampsMatchSampled, per channel (evenly spaced, both
+// ends included)
+constexpr size_t kRampSampleCount = 16;
+
+// rampsMatch over kRampSampleCount entries only. A silently rejected ramp
+// differs almost everywhere, so a sparse check still catches it once the
+// monitor has passed a full one.
+bool rampsMatchSampled(const GammaRamp& expected, const GammaRamp& actual,
+                       int tolerance = kRampMatchTolerance);
+
+// Eased interpolation from -> to, excluding both endpoints
+void buildTransitionFrames(const GammaRamp& from, const GammaRamp& to,
+                           size_t frame_count, std::vector<GammaRamp>& frames);
+
+// What a monitor's driver has accepted and rejected, per input level, as
+// the absolute deviation from identity (largest of the three channels).
+// Drivers refuse ramps that stray too far from identity, and the bound is
+// deterministic, so every verified outcome narrows it.
+struct RampEnvelope {
+    static constexpr int32_t kUnknown = 65536;
+
+    RampEnvelope() { limit.fill(kUnknown); }
+
+    std::array<int32_t, 256> safe{};  // Largest deviation seen in an accepted ramp
+    std::array<int32_t, 256> limit;   // Smallest deviation suspected rejected
+    bool learned = false;             // Any outcome recorded yet
+};
+
+// Width of a safe..limit bracket not worth probing further (one 8-bit step)
+constexpr int32_t kEnvelopeResolution = 256;
+
+// An accepted ramp proves its deviation safe at every level (less the
+// verification tolerance).
+void learnAcceptedRamp(RampEnvelope& envelope, const GammaRamp& ramp);
+
+// A rejected ramp went too far at one or more of the levels where it
+// exceeded the known-safe deviation; which one is unknown, so all of them
+// are marked. That may under-estimate innocent levels, which the next
+// accepted ramp past them corrects.
+void learnRejectedRamp(RampEnvelope& envelope, const GammaRamp& ramp);
+
+// ideal with each level's deviation clamped to what the envelope allows:
+// unbounded where nothing was rejected, the safe deviation where the
+// bracket is resolved, and (probe) halfway into an open bracket or
+// (!probe) the safe deviation there as well. Monotonic.
+GammaRamp projectOntoEnvelope(const GammaRamp& ideal, const RampEnvelope& envelope, bool probe);
+
+// Largest deviation of accepted relative to ideal's (0-1), the equivalent
+// blend scale for persistence and display
+double effectiveRampScale(const GammaRamp& ideal, const GammaRamp& accepted);
+
+// Outcome of reading a pushed ramp back from the device
+enum class RampReadback {
+    Matched,     // The ramp is applied
+    Mismatched,  // Silently rejected (the device holds something else)
+    Failed,      // Couldn't be read (mode switch, lock, remote session)
+};
+
+struct RampSearchResult {
+    bool success = false;
+    double scale = 0.0;   // Largest scale the device accepted
+    GammaRamp accepted{};  // The ramp at that scale (left applied on success)
+    int attempts = 0;      // Set calls made, including the final re-apply
+    bool hard_failure = false;  // A set or readback failed outright
+};
+
+// Binary search for the largest blend of ideal toward identity that the
+// device accepts, starting at start_scale. set(ramp) pushes a ramp and
+// returns false on a hard failure; verify(ramp) reads it back and returns
+// a RampReadback; anything but Matched shrinks the range. On success the accepted ramp is left applied;
+// on failure nothing is restored (the caller decides what to fall back to).
+template <typename SetFn, typename VerifyFn>
+RampSearchResult searchRampScale(const GammaRamp& ideal, double start_scale,
+                                 SetFn&& set, VerifyFn&& verify)
+{
+    static const GammaRamp identity = buildIdentityRamp();
+
+    // Binary search bounds
+    double low = 0.0;
+    double high = start_scale;
+
+    constexpr int kMaxAttempts = 6;
+    RampSearchResult result;
+    result.accepted = identity;
+
+    for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+        double try_scale = (attempt == 0) ? high : 0.5 * (low + high);
+
+        GammaRamp blended = blendRampTowardIdentity(ideal, identity, try_scale);
+        enforceMonotonicity(blended);
+
+        ++result.attempts;
+        if (!set(blended)) {
+            // Hard failure (API returned FALSE) - shrink range
+            result.hard_failure = true;
+            high = try_scale;
+            continue;
+        }
+
+        // The set call succeeded, but it might have silently rejected
+        RampReadback readback = verify(blended);
+        if (readback == RampReadback::Matched) {
+            // Success! Remember this scale and try to expand
+            low = try_scale;
+            result.accepted = blended;
+            result.success = true;
+            result.scale = try_scale;
+
+            // If we're close enough to our target scale, stop
+            if (high - low < 0.02) {
+                break;
+            }
+        } else {
+            // Silent rejection (or an unreadable device) - shrink range
+            result.hard_failure |= readback == RampReadback::Failed;
+            high = try_scale;
+        }
+    }
+
+    // If our last attempt wasn't the good one, re-apply
+    if (result.success && high != low) {
+        ++result.attempts;
+        set(result.accepted);
+    }
+    return result;
+}
+
+// Push ideal projected onto the envelope, learning from each outcome: the
+// probing projection (or first_candidate, if given), then after each
+// rejection the projection on the narrowed envelope - a per-level
+// bisection, with the last attempt limited to proven-safe deviations. On
+// a cold envelope that costs a few sets; once it has resolved the driver's
+// bound, almost every call takes one. Only a readback that differs is
+// learned from: a hard set or read failure says nothing about the bound
+// (the device may just be mid mode switch), so it stops the fit with
+// hard_failure set and the envelope untouched. Otherwise fails only if the
+// driver isn't behaving like a per-level bound; the caller then falls back
+// to searchRampScale.
+template <typename SetFn, typename VerifyFn>
+RampSearchResult fitRampToEnvelope(const GammaRamp& ideal, RampEnvelope& envelope,
+                                   const GammaRamp* first_candidate,
+                                   SetFn&& set, VerifyFn&& verify)
+{
+    constexpr int kMaxAttempts = 6;
+    RampSearchResult result;
+    GammaRamp previous{};
+
+    for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+        const bool probe = attempt + 1 < kMaxAttempts;
+        GammaRamp candidate = (attempt == 0 && first_candidate)
+            ? *first_candidate
+            : projectOntoEnvelope(ideal, envelope, probe);
+
+        // Nothing new to try at this attempt
+        if (attempt > 0 && candidate == previous) {
+            continue;
+        }
+        previous = candidate;
+
+        ++result.attempts;
+        RampReadback readback = set(candidate) ? verify(candidate) : RampReadback::Failed;
+        if (readback == RampReadback::Matched) {
+            learnAcceptedRamp(envelope, candidate);
+            result.success = true;
+            result.accepted = candidate;
+            result.scale = effectiveRampScale(ideal, candidate);
+            return result;
+        }
+        if (readback == RampReadback::Failed) {
+            result.hard_failure = true;
+            return result;
+        }
+        learnRejectedRamp(envelope, candidate);
+    }
+    return result;
+}
+
+} // namespace lumos::platform
@@ -3,56 +3,519 @@
 // License: GPL v2
 
 #include "screen_histogram.h"
+#include "luminance_kernel.h"
+#include "perf_trace.h"
+#include <d3d11.h>
+#include <d3dcompiler.h>
+#include <dxgi1_2.h>
 #include <algorithm>
 #include <array>
+#include <cstring>
+#include <functional>
 
 namespace lumos::platform {
 
+namespace {
+
+template <typename T>
+void SafeRelease(T*& ptr)
+{
+    if (ptr) {
+        ptr->Release();
+        ptr = nullptr;
+    }
+}
+
+// How long to wait before retrying Desktop Duplication after it failed
+// (e.g. secure desktop, fullscreen exclusive app, or another duplicator)
+constexpr ULONGLONG kDuplicationRetryMs = 5000;
+
+// Full-resolution luminance histogram. Each 16x16 group bins its pixels in
+// groupshared memory, then adds its 256 counts to the global bins, so global
+// atomics scale with group count rather than pixel count. Luminance uses the
+// same 15-bit fixed-point weights as the CPU kernels (luminance_kernel.h).
+constexpr char kHistogramShader[] = R"(
+Texture2D<float4> Desktop : register(t0);
+RWByteAddressBuffer Bins : register(u0);
+cbuffer Params : register(b0) { uint2 Size; uint2 Pad; };
+
+groupshared uint LocalBins[256];
+
+[numthreads(16, 16, 1)]
+void main(uint3 dtid : SV_DispatchThreadID, uint gi : SV_GroupIndex)
+{
+    LocalBins[gi] = 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    if (dtid.x < Size.x && dtid.y < Size.y) {
+        uint3 rgb = (uint3)round(Desktop.Load(int3(dtid.xy, 0)).rgb * 255.0);
+        uint lum = (6966 * rgb.r + 23436 * rgb.g + 2366 * rgb.b) >> 15;
+        InterlockedAdd(LocalBins[lum], 1);
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    uint count = LocalBins[gi];
+    if (count != 0) {
+        Bins.InterlockedAdd(gi * 4, count);
+    }
+}
+)";
+
+constexpr UINT kHistogramGroupSize = 16;
+
+} // anonymous namespace
+
+ScreenHistogramCapture::ScreenHistogramCapture()
+{
+    update_event_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    stop_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+}
+
 ScreenHistogramCapture::~ScreenHistogramCapture()
 {
     stop();
+    if (update_event_) {
+        CloseHandle(update_event_);
+    }
+    if (stop_event_) {
+        CloseHandle(stop_event_);
+    }
+}
+
+void ScreenHistogramCapture::setMonitors(const std::vector<HMONITOR>& monitors)
+{
+    bool was_running = running_;
+    stop();
+    monitors_ = monitors;
+    if (was_running) {
+        start();
+    }
 }
 
 void ScreenHistogramCapture::start()
 {
     if (running_) return;
 
+    std::vector<HMONITOR> monitors = monitors_;
+    if (monitors.empty()) {
+        monitors.push_back(MonitorFromPoint(POINT{0, 0}, MONITOR_DEFAULTTOPRIMARY));
+    }
+
+    for (HMONITOR monitor : monitors) {
+        MONITORINFO info = {};
+        info.cbSize = sizeof(info);
+        if (!GetMonitorInfoW(monitor, &info)) {
+            continue;
+        }
+
+        auto out = std::make_unique<Output>();
+        out->monitor = monitor;
+        out->rect = info.rcMonitor;
+        outputs_.push_back(std::move(out));
+    }
+
+    // Threads start once outputs_ is complete; publishHistogram walks it
+    if (stop_event_) {
+        ResetEvent(stop_event_);
+    }
     running_ = true;
-    capture_thread_ = std::thread(&ScreenHistogramCapture::captureThread, this);
+    for (auto& out : outputs_) {
+        out->thread = std::thread(&ScreenHistogramCapture::captureThread, this, std::ref(*out));
+    }
 }
 
 void ScreenHistogramCapture::stop()
 {
     running_ = false;
-    if (capture_thread_.joinable()) {
-        capture_thread_.join();
+    if (stop_event_) {
+        SetEvent(stop_event_);
+    }
+    for (auto& out : outputs_) {
+        if (out->thread.joinable()) {
+            out->thread.join();
+        }
+    }
+    outputs_.clear();
+}
+
+const ScreenHistogram& ScreenHistogramCapture::getHistogram() const
+{
+    combined_.update();
+    return combined_.front();
+}
+
+const ScreenHistogram& ScreenHistogramCapture::getHistogram(HMONITOR monitor) const
+{
+    static const ScreenHistogram kNoHistogram;
+    for (const auto& out : outputs_) {
+        if (out->monitor == monitor) {
+            out->published.update();
+            return out->published.front();
+        }
     }
+    return kNoHistogram;
 }
 
-ScreenHistogram ScreenHistogramCapture::getHistogram() const
+bool ScreenHistogramCapture::isUsingDuplication() const
 {
-    std::lock_guard<std::mutex> lock(histogram_mutex_);
-    return histogram_;
+    for (const auto& out : outputs_) {
+        if (out->using_duplication) return true;
+    }
+    return false;
+}
+
+bool ScreenHistogramCapture::isGpuHistogramActive() const
+{
+    for (const auto& out : outputs_) {
+        if (out->gpu_histogram_active) return true;
+    }
+    return false;
 }
 
-void ScreenHistogramCapture::captureThread()
+void ScreenHistogramCapture::captureThread(Output& out)
 {
     while (running_) {
         if (enabled_) {
-            captureScreen();
+            captureScreen(out);
+        }
+        WaitForSingleObject(stop_event_, static_cast<DWORD>(capture_interval_ms_));
+    }
+
+    // D3D objects belong to this thread
+    releaseDuplication(out);
+}
+
+void ScreenHistogramCapture::captureScreen(Output& out)
+{
+    PerfScope timer(PerfStage::HistogramCapture);
+
+    if (!out.duplication && out.duplication_unavailable &&
+        GetTickCount64() >= out.duplication_retry_tick) {
+        out.duplication_unavailable = false;
+    }
+
+    if (!out.duplication && !out.duplication_unavailable) {
+        if (!initDuplication(out)) {
+            releaseDuplication(out);
+            out.duplication_unavailable = true;
+            out.duplication_retry_tick = GetTickCount64() + kDuplicationRetryMs;
+        }
+    }
+
+    if (out.duplication) {
+        CaptureStatus status = captureDuplication(out);
+        if (status != CaptureStatus::Failed) {
+            out.using_duplication = true;
+            return;
         }
-        Sleep(capture_interval_ms_);
+
+        // Access lost (mode change, desktop switch) - rebuild later
+        releaseDuplication(out);
+        out.duplication_unavailable = true;
+        out.duplication_retry_tick = GetTickCount64() + kDuplicationRetryMs;
     }
+
+    out.using_duplication = false;
+    captureGdi(out);
 }
 
-void ScreenHistogramCapture::captureScreen()
+bool ScreenHistogramCapture::initDuplication(Output& out)
 {
-    // Get primary monitor dimensions
-    int screen_width = GetSystemMetrics(SM_CXSCREEN);
-    int screen_height = GetSystemMetrics(SM_CYSCREEN);
+    // Find the DXGI output that shows this monitor
+
+    IDXGIFactory1* factory = nullptr;
+    if (FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&factory)))) {
+        return false;
+    }
+
+    IDXGIAdapter1* adapter = nullptr;
+    IDXGIOutput* output = nullptr;
+    for (UINT a = 0; !output && factory->EnumAdapters1(a, &adapter) != DXGI_ERROR_NOT_FOUND; ++a) {
+        IDXGIOutput* candidate = nullptr;
+        for (UINT o = 0; adapter->EnumOutputs(o, &candidate) != DXGI_ERROR_NOT_FOUND; ++o) {
+            DXGI_OUTPUT_DESC desc = {};
+            if (SUCCEEDED(candidate->GetDesc(&desc)) && desc.Monitor == out.monitor) {
+                output = candidate;
+                break;
+            }
+            candidate->Release();
+        }
+        if (!output) {
+            SafeRelease(adapter);
+        }
+    }
+    factory->Release();
+
+    if (!output) {
+        return false;
+    }
+
+    // The duplication device must live on the adapter that owns the output
+    const D3D_FEATURE_LEVEL levels[] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_1, D3D_FEATURE_LEVEL_10_0 };
+    HRESULT hr = D3D11CreateDevice(
+        adapter, D3D_DRIVER_TYPE_UNKNOWN, nullptr, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+        levels, ARRAYSIZE(levels), D3D11_SDK_VERSION,
+        &out.device, nullptr, &out.context);
+    adapter->Release();
+
+    IDXGIOutput1* output1 = nullptr;
+    if (SUCCEEDED(hr)) {
+        hr = output->QueryInterface(IID_PPV_ARGS(&output1));
+    }
+    output->Release();
 
-    // Sample at lower resolution for performance (every 4th pixel)
-    const int sample_step = 4;
+    if (SUCCEEDED(hr)) {
+        hr = output1->DuplicateOutput(out.device, &out.duplication);
+        output1->Release();
+    }
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    DXGI_OUTDUPL_DESC dupl_desc = {};
+    out.duplication->GetDesc(&dupl_desc);
+
+    // HDR / high bit depth desktops use other formats; leave those to GDI
+    if (dupl_desc.ModeDesc.Format != DXGI_FORMAT_B8G8R8A8_UNORM) {
+        return false;
+    }
+
+    // Frames arrive unrotated in mode dimensions, which is all a histogram needs
+    UINT width = dupl_desc.ModeDesc.Width;
+    UINT height = dupl_desc.ModeDesc.Height;
+
+    // Mipmapped copy target: the GPU box-filters it down to kSampleMip
+    D3D11_TEXTURE2D_DESC tex_desc = {};
+    tex_desc.Width = width;
+    tex_desc.Height = height;
+    tex_desc.MipLevels = kSampleMip + 1;
+    tex_desc.ArraySize = 1;
+    tex_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    tex_desc.SampleDesc.Count = 1;
+    tex_desc.Usage = D3D11_USAGE_DEFAULT;
+    tex_desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    tex_desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+    if (FAILED(out.device->CreateTexture2D(&tex_desc, nullptr, &out.mip_texture))) {
+        return false;
+    }
+    if (FAILED(out.device->CreateShaderResourceView(out.mip_texture, nullptr, &out.mip_srv))) {
+        return false;
+    }
+
+    // CPU-readable copy of the small mip only
+    out.sample_width = (std::max)(1u, width >> kSampleMip);
+    out.sample_height = (std::max)(1u, height >> kSampleMip);
+
+    D3D11_TEXTURE2D_DESC staging_desc = {};
+    staging_desc.Width = out.sample_width;
+    staging_desc.Height = out.sample_height;
+    staging_desc.MipLevels = 1;
+    staging_desc.ArraySize = 1;
+    staging_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    staging_desc.SampleDesc.Count = 1;
+    staging_desc.Usage = D3D11_USAGE_STAGING;
+    staging_desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    if (FAILED(out.device->CreateTexture2D(&staging_desc, nullptr, &out.staging_texture))) {
+        return false;
+    }
+
+    // Optional: GPU histogram. Without it the mip readback path is used.
+    out.gpu_histogram_active = initComputeHistogram(out, width, height);
+
+    return true;
+}
+
+bool ScreenHistogramCapture::initComputeHistogram(Output& out, UINT width, UINT height)
+{
+    // cs_5_0 with typed UAV atomics needs feature level 11
+    if (out.device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        return false;
+    }
+
+    ID3DBlob* bytecode = nullptr;
+    ID3DBlob* errors = nullptr;
+    HRESULT hr = D3DCompile(kHistogramShader, sizeof(kHistogramShader) - 1, "histogram.hlsl",
+                            nullptr, nullptr, "main", "cs_5_0",
+                            D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &bytecode, &errors);
+    SafeRelease(errors);
+    if (FAILED(hr)) {
+        return false;
+    }
+    hr = out.device->CreateComputeShader(bytecode->GetBufferPointer(), bytecode->GetBufferSize(),
+                                           nullptr, &out.histogram_cs);
+    bytecode->Release();
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    // View of mip 0 only (the full-chain SRV is used for GenerateMips)
+    D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+    srv_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srv_desc.Texture2D.MostDetailedMip = 0;
+    srv_desc.Texture2D.MipLevels = 1;
+    if (FAILED(out.device->CreateShaderResourceView(out.mip_texture, &srv_desc, &out.full_res_srv))) {
+        return false;
+    }
+
+    // 256 uint bins as a raw buffer (byte-address atomics)
+    D3D11_BUFFER_DESC bins_desc = {};
+    bins_desc.ByteWidth = 256 * sizeof(uint32_t);
+    bins_desc.Usage = D3D11_USAGE_DEFAULT;
+    bins_desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+    bins_desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+    if (FAILED(out.device->CreateBuffer(&bins_desc, nullptr, &out.bins_buffer))) {
+        return false;
+    }
+
+    D3D11_UNORDERED_ACCESS_VIEW_DESC uav_desc = {};
+    uav_desc.Format = DXGI_FORMAT_R32_TYPELESS;
+    uav_desc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+    uav_desc.Buffer.NumElements = 256;
+    uav_desc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+    if (FAILED(out.device->CreateUnorderedAccessView(out.bins_buffer, &uav_desc, &out.bins_uav))) {
+        return false;
+    }
+
+    D3D11_BUFFER_DESC staging_desc = {};
+    staging_desc.ByteWidth = bins_desc.ByteWidth;
+    staging_desc.Usage = D3D11_USAGE_STAGING;
+    staging_desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    if (FAILED(out.device->CreateBuffer(&staging_desc, nullptr, &out.bins_staging))) {
+        return false;
+    }
+
+    const uint32_t params[4] = { width, height, 0, 0 };
+    D3D11_BUFFER_DESC params_desc = {};
+    params_desc.ByteWidth = sizeof(params);
+    params_desc.Usage = D3D11_USAGE_IMMUTABLE;
+    params_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    D3D11_SUBRESOURCE_DATA params_data = {};
+    params_data.pSysMem = params;
+    if (FAILED(out.device->CreateBuffer(&params_desc, &params_data, &out.cs_params))) {
+        return false;
+    }
+
+    out.full_width = width;
+    out.full_height = height;
+    return true;
+}
+
+bool ScreenHistogramCapture::computeHistogramGpu(Output& out)
+{
+    const UINT zeros[4] = { 0, 0, 0, 0 };
+    out.context->ClearUnorderedAccessViewUint(out.bins_uav, zeros);
+
+    out.context->CSSetShader(out.histogram_cs, nullptr, 0);
+    out.context->CSSetShaderResources(0, 1, &out.full_res_srv);
+    out.context->CSSetUnorderedAccessViews(0, 1, &out.bins_uav, nullptr);
+    out.context->CSSetConstantBuffers(0, 1, &out.cs_params);
+    out.context->Dispatch((out.full_width + kHistogramGroupSize - 1) / kHistogramGroupSize,
+                            (out.full_height + kHistogramGroupSize - 1) / kHistogramGroupSize, 1);
+
+    // Unbind so the texture can be a copy destination again next frame
+    ID3D11ShaderResourceView* null_srv = nullptr;
+    ID3D11UnorderedAccessView* null_uav = nullptr;
+    out.context->CSSetShaderResources(0, 1, &null_srv);
+    out.context->CSSetUnorderedAccessViews(0, 1, &null_uav, nullptr);
+
+    out.context->CopyResource(out.bins_staging, out.bins_buffer);
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(out.context->Map(out.bins_staging, 0, D3D11_MAP_READ, 0, &mapped))) {
+        return false;
+    }
+    std::array<uint32_t, 256> raw_histogram{};
+    std::memcpy(raw_histogram.data(), mapped.pData, sizeof(raw_histogram));
+    out.context->Unmap(out.bins_staging, 0);
+
+    publishHistogram(out, raw_histogram, static_cast<uint64_t>(out.full_width) * out.full_height);
+    return true;
+}
+
+void ScreenHistogramCapture::releaseDuplication(Output& out)
+{
+    SafeRelease(out.cs_params);
+    SafeRelease(out.bins_staging);
+    SafeRelease(out.bins_uav);
+    SafeRelease(out.bins_buffer);
+    SafeRelease(out.full_res_srv);
+    SafeRelease(out.histogram_cs);
+    out.gpu_histogram_active = false;
+
+    SafeRelease(out.staging_texture);
+    SafeRelease(out.mip_srv);
+    SafeRelease(out.mip_texture);
+    SafeRelease(out.duplication);
+    SafeRelease(out.context);
+    SafeRelease(out.device);
+}
+
+ScreenHistogramCapture::CaptureStatus ScreenHistogramCapture::captureDuplication(Output& out)
+{
+    // Zero timeout: DXGI accumulates updates between calls, so this returns
+    // a frame only if something was presented since the last sample
+    DXGI_OUTDUPL_FRAME_INFO frame_info = {};
+    IDXGIResource* resource = nullptr;
+    HRESULT hr = out.duplication->AcquireNextFrame(0, &frame_info, &resource);
+
+    if (hr == DXGI_ERROR_WAIT_TIMEOUT) {
+        return CaptureStatus::NoChange;
+    }
+    if (FAILED(hr)) {
+        return CaptureStatus::Failed;
+    }
+
+    // Mouse-only updates don't change the desktop image
+    if (frame_info.LastPresentTime.QuadPart == 0) {
+        resource->Release();
+        out.duplication->ReleaseFrame();
+        return CaptureStatus::NoChange;
+    }
+
+    ID3D11Texture2D* desktop = nullptr;
+    hr = resource->QueryInterface(IID_PPV_ARGS(&desktop));
+    resource->Release();
+    if (FAILED(hr)) {
+        out.duplication->ReleaseFrame();
+        return CaptureStatus::Failed;
+    }
+
+    out.context->CopySubresourceRegion(out.mip_texture, 0, 0, 0, 0, desktop, 0, nullptr);
+    desktop->Release();
+    out.duplication->ReleaseFrame();
+
+    if (gpu_histogram_enabled_ && out.histogram_cs) {
+        return computeHistogramGpu(out) ? CaptureStatus::Captured : CaptureStatus::Failed;
+    }
+
+    out.context->GenerateMips(out.mip_srv);
+    out.context->CopySubresourceRegion(out.staging_texture, 0, 0, 0, 0, out.mip_texture, kSampleMip, nullptr);
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(out.context->Map(out.staging_texture, 0, D3D11_MAP_READ, 0, &mapped))) {
+        return CaptureStatus::Failed;
+    }
+
+    std::array<uint32_t, 256> raw_histogram{};
+    accumulateLuminance(static_cast<const uint8_t*>(mapped.pData),
+                        static_cast<int>(out.sample_width), static_cast<int>(out.sample_height),
+                        static_cast<int>(mapped.RowPitch), raw_histogram);
+    out.context->Unmap(out.staging_texture, 0);
+
+    publishHistogram(out, raw_histogram, static_cast<uint64_t>(out.sample_width) * out.sample_height);
+    return CaptureStatus::Captured;
+}
+
+bool ScreenHistogramCapture::captureGdi(Output& out)
+{
+    // Only this output's part of the virtual desktop
+    int screen_width = out.rect.right - out.rect.left;
+    int screen_height = out.rect.bottom - out.rect.top;
+
+    int bitmap_width = screen_width / kSampleStep;
+    int bitmap_height = screen_height / kSampleStep;
+    if (bitmap_width <= 0 || bitmap_height <= 0) return false;
 
     // Create compatible DC and bitmap
     HDC hScreenDC = GetDC(nullptr);
@@ -60,10 +523,10 @@ void ScreenHistogramCapture::captureScreen()
 
     BITMAPINFO bmi = {};
     bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = screen_width / sample_step;
-    bmi.bmiHeader.biHeight = -screen_height / sample_step;  // Negative for top-down
+    bmi.bmiHeader.biWidth = bitmap_width;
+    bmi.bmiHeader.biHeight = -bitmap_height;  // Negative for top-down
     bmi.bmiHeader.biPlanes = 1;
-    bmi.bmiHeader.biBitCount = 24;
+    bmi.bmiHeader.biBitCount = 32;            // BGRA, same layout as the DXGI path
     bmi.bmiHeader.biCompression = BI_RGB;
 
     void* pBits = nullptr;
@@ -72,7 +535,7 @@ void ScreenHistogramCapture::captureScreen()
     if (!hBitmap || !pBits) {
         DeleteDC(hMemDC);
         ReleaseDC(nullptr, hScreenDC);
-        return;
+        return false;
     }
 
     HGDIOBJ hOldBitmap = SelectObject(hMemDC, hBitmap);
@@ -80,37 +543,14 @@ void ScreenHistogramCapture::captureScreen()
     // Capture screen with stretch (downsampling)
     SetStretchBltMode(hMemDC, HALFTONE);
     StretchBlt(
-        hMemDC, 0, 0, screen_width / sample_step, screen_height / sample_step,
-        hScreenDC, 0, 0, screen_width, screen_height,
+        hMemDC, 0, 0, bitmap_width, bitmap_height,
+        hScreenDC, out.rect.left, out.rect.top, screen_width, screen_height,
         SRCCOPY);
 
     // Calculate histogram
-    std::array<int, 256> raw_histogram{};
-    int total_pixels = 0;
-
-    int bitmap_width = screen_width / sample_step;
-    int bitmap_height = screen_height / sample_step;
-    int row_stride = ((bitmap_width * 3 + 3) / 4) * 4;  // 24-bit rows are DWORD-aligned
-
-    BYTE* pixels = static_cast<BYTE*>(pBits);
-
-    for (int y = 0; y < bitmap_height; ++y) {
-        BYTE* row = pixels + y * row_stride;
-        for (int x = 0; x < bitmap_width; ++x) {
-            // BGR order in 24-bit DIB
-            BYTE b = row[x * 3 + 0];
-            BYTE g = row[x * 3 + 1];
-            BYTE r = row[x * 3 + 2];
-
-            // Calculate relative luminance (Rec. 709 coefficients)
-            // Y = 0.2126 R + 0.7152 G + 0.0722 B
-            int luminance = static_cast<int>(0.2126f * r + 0.7152f * g + 0.0722f * b);
-            luminance = std::clamp(luminance, 0, 255);
-
-            raw_histogram[luminance]++;
-            total_pixels++;
-        }
-    }
+    std::array<uint32_t, 256> raw_histogram{};
+    accumulateLuminance(static_cast<const uint8_t*>(pBits), bitmap_width, bitmap_height,
+                        bitmap_width * 4, raw_histogram);
 
     // Cleanup GDI
     SelectObject(hMemDC, hOldBitmap);
@@ -118,13 +558,24 @@ void ScreenHistogramCapture::captureScreen()
     DeleteDC(hMemDC);
     ReleaseDC(nullptr, hScreenDC);
 
+    publishHistogram(out, raw_histogram, static_cast<uint64_t>(bitmap_width) * bitmap_height);
+    return true;
+}
+
+namespace {
+
+// Bins as a fraction of total (raw counts, or area-weighted fractions for
+// the combined histogram)
+template <typename Count>
+ScreenHistogram normalizeHistogram(const std::array<Count, 256>& raw_histogram, double total_pixels)
+{
     // Normalize histogram
     ScreenHistogram result;
     result.max_value = 0.0f;
 
-    if (total_pixels > 0) {
+    if (total_pixels > 0.0) {
         for (int i = 0; i < 256; ++i) {
-            result.luminance[i] = static_cast<float>(raw_histogram[i]) / total_pixels;
+            result.luminance[i] = static_cast<float>(raw_histogram[i] / total_pixels);
             if (result.luminance[i] > result.max_value) {
                 result.max_value = result.luminance[i];
             }
@@ -139,10 +590,47 @@ void ScreenHistogramCapture::captureScreen()
         result.valid = true;
     }
 
-    // Thread-safe update
-    {
-        std::lock_guard<std::mutex> lock(histogram_mutex_);
-        histogram_ = result;
+    return result;
+}
+
+} // anonymous namespace
+
+void ScreenHistogramCapture::publishHistogram(Output& out,
+                                              const std::array<uint32_t, 256>& raw_histogram,
+                                              uint64_t total_pixels)
+{
+    ScreenHistogram& result = out.published.back();
+    result = normalizeHistogram(raw_histogram, static_cast<double>(total_pixels));
+
+    // Outputs sample at different resolutions (the GPU path counts every
+    // pixel, the mip and GDI paths about 1/16 of them), so the combined
+    // histogram weights each output's bin fractions by its desktop area
+    std::lock_guard<std::mutex> lock(combine_mutex_);
+    result.generation = ++out.generation;
+    out.published.publish();
+    out.raw = raw_histogram;
+    out.total = total_pixels;
+
+    std::array<double, 256> combined{};
+    double combined_area = 0.0;
+    for (const auto& output : outputs_) {
+        if (output->total == 0) continue;
+        double area = static_cast<double>(output->rect.right - output->rect.left) *
+                      static_cast<double>(output->rect.bottom - output->rect.top);
+        if (area <= 0.0) continue;
+        double weight = area / static_cast<double>(output->total);
+        for (int i = 0; i < 256; ++i) {
+            combined[i] += output->raw[i] * weight;
+        }
+        combined_area += area;
+    }
+    ScreenHistogram& combined_result = combined_.back();
+    combined_result = normalizeHistogram(combined, combined_area);
+    combined_result.generation = ++combined_generation_;
+    combined_.publish();
+
+    if (update_event_) {
+        SetEvent(update_event_);
     }
 }
 
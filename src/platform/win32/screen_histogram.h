@@ -15,8 +15,21 @@
 #include <windows.h>
 #include <array>
 #include <atomic>
-#include <thread>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
+#include "triple_buffer.h"
+
+struct ID3D11Device;
+struct ID3D11DeviceContext;
+struct ID3D11Texture2D;
+struct ID3D11ShaderResourceView;
+struct ID3D11ComputeShader;
+struct ID3D11Buffer;
+struct ID3D11UnorderedAccessView;
+struct IDXGIOutputDuplication;
 
 namespace lumos::platform {
 
@@ -25,38 +38,142 @@ struct ScreenHistogram {
     std::array<float, 256> luminance{};  // Normalized histogram (0.0 - 1.0)
     float max_value = 0.0f;               // Maximum bin value before normalization
     bool valid = false;                   // Whether data is valid
+    uint64_t generation = 0;              // Increments with every new sample
 };
 
-// Captures screen content and computes luminance histogram
+// Captures screen content and computes luminance histograms, one per
+// monitor. Each output is sampled on its own thread with its own Desktop
+// Duplication (or GDI) source, so outputs are captured in parallel and an
+// unchanged output costs almost nothing.
 class ScreenHistogramCapture {
 public:
-    ScreenHistogramCapture() = default;
+    ScreenHistogramCapture();
     ~ScreenHistogramCapture();
 
-    // Start/stop background capture thread
+    // Monitors to sample (typically the Gamma monitor handles). Restarts
+    // capture if it's running. Without any, the primary monitor is used.
+    void setMonitors(const std::vector<HMONITOR>& monitors);
+
+    // Start/stop background capture threads. stop() returns promptly, it
+    // doesn't wait out the capture interval.
     void start();
     void stop();
+    bool isRunning() const { return running_; }
+
+    // Histogram of all monitors combined, weighted by pixel count. Lock-free
+    // snapshot for a single reader thread (the UI thread); the reference
+    // stays valid until the next call. Compare generation to skip work
+    // when no new sample has arrived.
+    const ScreenHistogram& getHistogram() const;
 
-    // Get current histogram (thread-safe)
-    ScreenHistogram getHistogram() const;
+    // Histogram of one monitor (invalid if it isn't being sampled). Same
+    // single-reader rules as above.
+    const ScreenHistogram& getHistogram(HMONITOR monitor) const;
 
     // Set capture interval in milliseconds
     void setCaptureInterval(int ms) { capture_interval_ms_ = ms; }
 
+    // Auto-reset event signaled whenever a new combined histogram is published
+    HANDLE updateEvent() const { return update_event_; }
+
     // Enable/disable capture
     void setEnabled(bool enabled) { enabled_ = enabled; }
     bool isEnabled() const { return enabled_; }
 
+    // Whether the last sample came from Desktop Duplication (vs. GDI) on
+    // at least one output
+    bool isUsingDuplication() const;
+
+    // Build the histogram with a compute shader at full resolution (only
+    // with Desktop Duplication on a feature level 11 device)
+    void setGpuHistogramEnabled(bool enabled) { gpu_histogram_enabled_ = enabled; }
+    bool isGpuHistogramEnabled() const { return gpu_histogram_enabled_; }
+    bool isGpuHistogramActive() const;
+
 private:
-    void captureThread();
-    void captureScreen();
+    // Sample at lower resolution for performance (every 4th pixel)
+    static constexpr int kSampleStep = 4;
+    static constexpr UINT kSampleMip = 2;  // Mip level that is 1/kSampleStep size
+
+    enum class CaptureStatus {
+        Captured,   // New histogram published
+        NoChange,   // Desktop unchanged since the last sample, nothing to do
+        Failed,     // Backend unavailable, try the fallback
+    };
+
+    // One sampled monitor. The D3D objects belong to its capture thread;
+    // raw/total/generation are guarded by combine_mutex_.
+    struct Output {
+        HMONITOR monitor = nullptr;
+        RECT rect = {};  // Desktop coordinates, for the GDI fallback
+        std::thread thread;
+        std::atomic<bool> using_duplication{false};
+        std::atomic<bool> gpu_histogram_active{false};
+
+        // Desktop Duplication state
+        ID3D11Device* device = nullptr;
+        ID3D11DeviceContext* context = nullptr;
+        IDXGIOutputDuplication* duplication = nullptr;
+        ID3D11Texture2D* mip_texture = nullptr;
+        ID3D11ShaderResourceView* mip_srv = nullptr;
+        ID3D11Texture2D* staging_texture = nullptr;
+        UINT sample_width = 0;
+        UINT sample_height = 0;
+        bool duplication_unavailable = false;  // Don't retry init every sample
+        ULONGLONG duplication_retry_tick = 0;
+
+        // Compute histogram state
+        ID3D11ComputeShader* histogram_cs = nullptr;
+        ID3D11ShaderResourceView* full_res_srv = nullptr;
+        ID3D11Buffer* bins_buffer = nullptr;
+        ID3D11UnorderedAccessView* bins_uav = nullptr;
+        ID3D11Buffer* bins_staging = nullptr;
+        ID3D11Buffer* cs_params = nullptr;
+        UINT full_width = 0;
+        UINT full_height = 0;
+
+        // Latest sample
+        std::array<uint32_t, 256> raw{};
+        uint64_t total = 0;
+        uint64_t generation = 0;
+        mutable TripleBuffer<ScreenHistogram> published;
+    };
+
+    void captureThread(Output& out);
+    void captureScreen(Output& out);
+
+    // Desktop Duplication backend: copies the frame into a mipmapped
+    // texture, lets the GPU downsample it, and maps only the small mip
+    bool initDuplication(Output& out);
+    void releaseDuplication(Output& out);
+    CaptureStatus captureDuplication(Output& out);
+
+    // Compute shader histogram over mip 0 of mip_texture: 256 bins built
+    // with groupshared atomics, only 1 KB is read back
+    bool initComputeHistogram(Output& out, UINT width, UINT height);
+    bool computeHistogramGpu(Output& out);
+
+    // GDI fallback: HALFTONE StretchBlt of the output's desktop rectangle
+    bool captureGdi(Output& out);
+
+    // Normalize and publish a raw histogram, then refresh the combined one
+    void publishHistogram(Output& out, const std::array<uint32_t, 256>& raw_histogram,
+                          uint64_t total_pixels);
+
+    std::vector<HMONITOR> monitors_;
+    std::vector<std::unique_ptr<Output>> outputs_;
 
-    std::thread capture_thread_;
-    mutable std::mutex histogram_mutex_;
-    ScreenHistogram histogram_;
+    // Capture threads serialize on combine_mutex_ to merge their samples
+    // into the combined histogram; the UI never takes it
+    std::mutex combine_mutex_;
+    uint64_t combined_generation_ = 0;
+    mutable TripleBuffer<ScreenHistogram> combined_;
+    HANDLE update_event_ = nullptr;
+    HANDLE stop_event_ = nullptr;  // Manual-reset, wakes capture threads early on stop()
 
     std::atomic<bool> running_{false};
     std::atomic<bool> enabled_{true};
+    std::atomic<bool> gpu_histogram_enabled_{true};
     int capture_interval_ms_ = 500;  // Update every 500ms by default
 };
 
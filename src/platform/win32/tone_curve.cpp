@@ -0,0 +1,293 @@
+// Lumos - Tone curve evaluation
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#include "tone_curve.h"
+#include <algorithm>
+#include <cmath>
+
+namespace lumos::platform {
+
+// Tone curve shape functions
+// NOTE: These are NOT calibrated transforms - they produce curve SHAPES
+// that happen to resemble certain standards, but are applied as simple
+// GPU output remaps with no device characterization or measurement.
+namespace {
+
+// std::pow isn't constexpr before C++26, so the fixed tables are built
+// with these. Accurate to a few ulps over the (0, 1] range used here.
+constexpr double kLn2 = 0.69314718055994530942;
+
+constexpr double cxLog(double x)
+{
+    int exponent = 0;
+    while (x >= 2.0) { x *= 0.5; ++exponent; }
+    while (x < 1.0) { x *= 2.0; --exponent; }
+
+    // ln(m) = 2 atanh((m - 1) / (m + 1)), m in [1, 2)
+    double z = (x - 1.0) / (x + 1.0);
+    double z2 = z * z;
+    double term = z;
+    double sum = 0.0;
+    for (int n = 1; n < 60; n += 2) {
+        sum += term / n;
+        term *= z2;
+    }
+    return 2.0 * sum + exponent * kLn2;
+}
+
+constexpr double cxExp(double y)
+{
+    // e^y = 2^n e^r with |r| <= ln2 / 2
+    int n = static_cast<int>(y / kLn2 + (y < 0.0 ? -0.5 : 0.5));
+    double r = y - n * kLn2;
+
+    double term = 1.0;
+    double sum = 1.0;
+    for (int k = 1; k < 30; ++k) {
+        term *= r / k;
+        sum += term;
+    }
+    for (; n > 0; --n) sum *= 2.0;
+    for (; n < 0; ++n) sum *= 0.5;
+    return sum;
+}
+
+constexpr double cxPow(double base, double exponent)
+{
+    return base <= 0.0 ? 0.0 : cxExp(exponent * cxLog(base));
+}
+
+// Shadow-lifting curve (raises dark values, sRGB-like shape)
+constexpr double shadowLiftCurve(double linear)
+{
+    if (linear <= 0.0031308)
+        return 12.92 * linear;
+    return 1.055 * cxPow(linear, 1.0 / 2.4) - 0.055;
+}
+
+// Soft contrast curve (gentle S-shape, Rec.709-like)
+constexpr double softContrastCurve(double linear)
+{
+    const double beta = 0.018;
+    const double alpha = 1.099;
+    const double gamma_exp = 0.45;
+
+    if (linear < beta)
+        return 4.5 * linear;
+    return alpha * cxPow(linear, gamma_exp) - (alpha - 1.0);
+}
+
+// Aggressive gamma 2.6 curve
+constexpr double cinemaCurve(double linear)
+{
+    return cxPow(linear, 1.0 / 2.6);
+}
+
+constexpr double linearCurve(double linear)
+{
+    return linear;
+}
+
+template <typename Shape>
+constexpr CurveTable makeTable(Shape shape)
+{
+    CurveTable table{};
+    for (size_t i = 0; i < kCurveSamples; ++i) {
+        table[i] = shape(static_cast<double>(i) / 255.0);
+    }
+    return table;
+}
+
+constexpr CurveTable kLinearTable = makeTable(linearCurve);
+constexpr CurveTable kShadowLiftTable = makeTable(shadowLiftCurve);
+constexpr CurveTable kSoftContrastTable = makeTable(softContrastCurve);
+constexpr CurveTable kCinemaTable = makeTable(cinemaCurve);
+
+// Spot checks against the closed forms (pow(128/255, 1/2.4) etc.)
+constexpr bool near(double a, double b) { return (a > b ? a - b : b - a) < 1e-12; }
+static_assert(near(kShadowLiftTable[255], 1.0));
+static_assert(near(kShadowLiftTable[128], 0.7366469419515869));
+static_assert(near(kSoftContrastTable[128], 0.7069332944441298));
+static_assert(near(kCinemaTable[128], 0.7671371166198763));
+
+// Simple power-law curve (runtime strength)
+double powerCurve(double linear, double strength)
+{
+    return std::pow(linear, 1.0 / strength);
+}
+
+// Blackbody color of a temperature as 0-1 RGB (Tanner Helland's fit of
+// the CIE 1964 10-degree data, good enough for display tinting)
+ChannelGains blackbodyColor(double kelvin)
+{
+    double t = kelvin / 100.0;
+    ChannelGains color;
+
+    color.red = (t <= 66.0) ? 255.0 : 329.698727446 * std::pow(t - 60.0, -0.1332047592);
+    color.green = (t <= 66.0)
+        ? 99.4708025861 * std::log(t) - 161.1195681661
+        : 288.1221695283 * std::pow(t - 60.0, -0.0755148492);
+    color.blue = (t >= 66.0) ? 255.0
+               : (t <= 19.0) ? 0.0
+               : 138.5177312231 * std::log(t - 10.0) - 305.0447927307;
+
+    color.red = std::clamp(color.red / 255.0, 0.0, 1.0);
+    color.green = std::clamp(color.green / 255.0, 0.0, 1.0);
+    color.blue = std::clamp(color.blue / 255.0, 0.0, 1.0);
+    return color;
+}
+
+} // anonymous namespace
+
+ChannelGains whitePointGains(double kelvin)
+{
+    kelvin = std::clamp(kelvin, kMinWhitePointK, kMaxWhitePointK);
+    if (kelvin == kNeutralWhitePointK) return {};
+
+    // Relative to the neutral point, then scaled down so nothing clips
+    static const ChannelGains neutral = blackbodyColor(kNeutralWhitePointK);
+    ChannelGains color = blackbodyColor(kelvin);
+    ChannelGains gains{color.red / neutral.red, color.green / neutral.green,
+                       color.blue / neutral.blue};
+    double peak = (std::max)({gains.red, gains.green, gains.blue});
+    gains.red /= peak;
+    gains.green /= peak;
+    gains.blue /= peak;
+    return gains;
+}
+
+CompiledCurve::CompiledCurve(const std::vector<CurvePoint>& points,
+                             CurveInterpolation interpolation)
+    : interpolation_(interpolation)
+{
+    std::vector<CurvePoint> sorted = points;
+    std::stable_sort(sorted.begin(), sorted.end());
+
+    xs_.reserve(sorted.size());
+    ys_.reserve(sorted.size());
+    for (const auto& pt : sorted) {
+        xs_.push_back(pt.x);
+        ys_.push_back(pt.y);
+    }
+    if (!valid() || interpolation_ != CurveInterpolation::MonotoneCubic) return;
+
+    // Fritsch-Carlson: secant-average tangents, flattened at local extrema
+    // and limited so no segment overshoots its endpoints
+    const size_t n = xs_.size();
+    std::vector<double> secants(n - 1);
+    for (size_t k = 0; k + 1 < n; ++k) {
+        double dx = xs_[k + 1] - xs_[k];
+        secants[k] = (dx > 0.0) ? (ys_[k + 1] - ys_[k]) / dx : 0.0;
+    }
+
+    tangents_.assign(n, 0.0);
+    tangents_[0] = secants[0];
+    tangents_[n - 1] = secants[n - 2];
+    for (size_t k = 1; k + 1 < n; ++k) {
+        tangents_[k] = (secants[k - 1] * secants[k] <= 0.0)
+            ? 0.0 : 0.5 * (secants[k - 1] + secants[k]);
+    }
+
+    for (size_t k = 0; k + 1 < n; ++k) {
+        if (secants[k] == 0.0) {
+            tangents_[k] = 0.0;
+            tangents_[k + 1] = 0.0;
+            continue;
+        }
+        double a = tangents_[k] / secants[k];
+        double b = tangents_[k + 1] / secants[k];
+        double magnitude = a * a + b * b;
+        if (magnitude > 9.0) {
+            double tau = 3.0 / std::sqrt(magnitude);
+            tangents_[k] = tau * a * secants[k];
+            tangents_[k + 1] = tau * b * secants[k];
+        }
+    }
+}
+
+double CompiledCurve::evaluateSegment(size_t segment, double x) const
+{
+    double x1 = xs_[segment];
+    double x2 = xs_[segment + 1];
+    double y1 = ys_[segment];
+    double y2 = ys_[segment + 1];
+    double h = x2 - x1;
+    if (h <= 0.0) return y2;
+
+    double t = (x - x1) / h;
+    if (interpolation_ != CurveInterpolation::MonotoneCubic) {
+        return y1 + t * (y2 - y1);
+    }
+
+    // Cubic Hermite basis
+    double t2 = t * t;
+    double t3 = t2 * t;
+    return (2.0 * t3 - 3.0 * t2 + 1.0) * y1
+         + (t3 - 2.0 * t2 + t) * h * tangents_[segment]
+         + (-2.0 * t3 + 3.0 * t2) * y2
+         + (t3 - t2) * h * tangents_[segment + 1];
+}
+
+double CompiledCurve::evaluate(double x) const
+{
+    if (!valid()) return x;
+    if (x <= xs_.front()) return ys_.front();
+    if (x >= xs_.back()) return ys_.back();
+
+    // First node strictly right of x; the segment starts one before it
+    size_t upper = static_cast<size_t>(std::upper_bound(xs_.begin(), xs_.end(), x) - xs_.begin());
+    return evaluateSegment(upper - 1, x);
+}
+
+void CompiledCurve::sample(CurveTable& out) const
+{
+    if (!valid()) {
+        for (size_t i = 0; i < kCurveSamples; ++i) out[i] = static_cast<double>(i) / 255.0;
+        return;
+    }
+
+    // Inputs increase monotonically, so the segment index only moves forward
+    size_t segment = 0;
+    const size_t last_segment = xs_.size() - 2;
+    for (size_t i = 0; i < kCurveSamples; ++i) {
+        double x = static_cast<double>(i) / 255.0;
+        if (x <= xs_.front()) { out[i] = ys_.front(); continue; }
+        if (x >= xs_.back()) { out[i] = ys_.back(); continue; }
+        while (segment < last_segment && x >= xs_[segment + 1]) ++segment;
+        out[i] = evaluateSegment(segment, x);
+    }
+}
+
+const CurveTable* presetCurveTable(ToneCurve curve)
+{
+    switch (curve) {
+        case ToneCurve::Linear: return &kLinearTable;
+        case ToneCurve::ShadowLift: return &kShadowLiftTable;
+        case ToneCurve::SoftContrast: return &kSoftContrastTable;
+        case ToneCurve::Cinema: return &kCinemaTable;
+        default: return nullptr;
+    }
+}
+
+void evaluateCurve(ToneCurve curve, double strength,
+                   const std::vector<CurvePoint>* custom_curve,
+                   CurveInterpolation interpolation, CurveTable& out)
+{
+    if (const CurveTable* table = presetCurveTable(curve)) {
+        out = *table;
+        return;
+    }
+    if (curve == ToneCurve::Custom) {
+        // Fallback to linear (identity) if no valid curve
+        CompiledCurve compiled = custom_curve ? CompiledCurve(*custom_curve, interpolation)
+                                              : CompiledCurve();
+        compiled.sample(out);
+        return;
+    }
+    for (size_t i = 0; i < kCurveSamples; ++i) {
+        out[i] = powerCurve(static_cast<double>(i) / 255.0, strength);
+    }
+}
+
+} // namespace lumos::platform
@@ -0,0 +1,65 @@
+// Lumos - Tone curve evaluation
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "gamma_types.h"
+
+namespace lumos::platform {
+
+// Curves are sampled at the 256 ramp inputs, x = i / 255
+constexpr size_t kCurveSamples = 256;
+using CurveTable = std::array<double, kCurveSamples>;
+
+// A custom curve prepared for repeated evaluation: points sorted and
+// slopes precomputed once per edit. evaluate() finds the segment by binary
+// search, sample() sweeps all 256 inputs in one pass over the segments.
+class CompiledCurve {
+public:
+    CompiledCurve() = default;
+    explicit CompiledCurve(const std::vector<CurvePoint>& points,
+                           CurveInterpolation interpolation = CurveInterpolation::Linear);
+
+    // Needs at least two points; an invalid curve evaluates as identity
+    bool valid() const { return xs_.size() >= 2; }
+
+    double evaluate(double x) const;
+    void sample(CurveTable& out) const;
+
+private:
+    double evaluateSegment(size_t segment, double x) const;
+
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+    std::vector<double> tangents_;  // Node slopes (MonotoneCubic only)
+    CurveInterpolation interpolation_ = CurveInterpolation::Linear;
+};
+
+// Compile-time table for a fixed-shape preset (Linear, ShadowLift,
+// SoftContrast, Cinema); nullptr for Power and Custom, which depend on
+// runtime parameters
+const CurveTable* presetCurveTable(ToneCurve curve);
+
+// Sample a curve at all 256 ramp inputs. Fixed presets copy their table.
+// This is the one implementation behind both Gamma::buildRamp and the UI
+// preview, so the two cannot drift apart.
+void evaluateCurve(ToneCurve curve, double strength,
+                   const std::vector<CurvePoint>* custom_curve,
+                   CurveInterpolation interpolation, CurveTable& out);
+
+// Per-channel output multipliers for a white point
+struct ChannelGains {
+    double red = 1.0;
+    double green = 1.0;
+    double blue = 1.0;
+};
+
+// Approximate blackbody white point, normalized so kNeutralWhitePointK is
+// (1, 1, 1) and no channel exceeds 1
+ChannelGains whitePointGains(double kelvin);
+
+} // namespace lumos::platform
@@ -0,0 +1,59 @@
+// Lumos - Lock-free latest-value buffer
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace lumos::platform {
+
+// Triple buffer for handing the newest value from one producer thread to
+// one consumer thread. The producer fills back() and publishes it; the
+// consumer calls update() and reads a stable front(). Neither side ever
+// blocks, and values the consumer didn't get to are simply overwritten.
+//
+// Several producers may share one buffer only if they serialize among
+// themselves (e.g. behind their own mutex).
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer: slot to fill. Its previous contents are stale, overwrite it fully.
+    T& back() { return slots_[back_]; }
+
+    // Producer: make back() the newest value
+    void publish()
+    {
+        uint8_t previous = middle_.exchange(static_cast<uint8_t>(back_ | kDirtyFlag),
+                                            std::memory_order_acq_rel);
+        back_ = previous & kSlotMask;
+    }
+
+    // Consumer: adopt the newest value, if any. Returns true if front() changed.
+    bool update()
+    {
+        if ((middle_.load(std::memory_order_acquire) & kDirtyFlag) == 0) {
+            return false;
+        }
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & kSlotMask;
+        return true;
+    }
+
+    // Consumer: latest adopted value (stable until the next update())
+    const T& front() const { return slots_[front_]; }
+
+private:
+    // The producer owns back_, the consumer owns front_, and middle_ holds
+    // the third index plus a "new data" flag
+    static constexpr uint8_t kSlotMask = 0x3;
+    static constexpr uint8_t kDirtyFlag = 0x4;
+    std::array<T, 3> slots_{};
+    uint8_t back_ = 0;
+    uint8_t front_ = 1;
+    std::atomic<uint8_t> middle_{2};
+};
+
+} // namespace lumos::platform
@@ -0,0 +1,314 @@
+// Lumos - Time-of-day schedule
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#include "schedule.h"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+namespace lumos {
+
+namespace {
+
+constexpr uint64_t kTicksPerMinute = 600000000ULL;
+constexpr uint64_t kTicksPerHour = 60ULL * kTicksPerMinute;
+constexpr uint64_t kTicksPerDay = 24ULL * kTicksPerHour;
+constexpr double kPi = 3.14159265358979323846;
+
+uint64_t toTicks(const FILETIME& ft)
+{
+    return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+
+FILETIME toFileTime(uint64_t ticks)
+{
+    FILETIME ft;
+    ft.dwLowDateTime = static_cast<DWORD>(ticks & 0xFFFFFFFFULL);
+    ft.dwHighDateTime = static_cast<DWORD>(ticks >> 32);
+    return ft;
+}
+
+// Local wall-clock ticks (no zone attached) <-> UTC ticks, honoring DST
+// for the date in question
+bool localToUtc(uint64_t local_ticks, uint64_t& utc_ticks)
+{
+    FILETIME ft = toFileTime(local_ticks);
+    SYSTEMTIME local, utc;
+    if (!FileTimeToSystemTime(&ft, &local)) return false;
+    if (!TzSpecificLocalTimeToSystemTime(nullptr, &local, &utc)) return false;
+    if (!SystemTimeToFileTime(&utc, &ft)) return false;
+    utc_ticks = toTicks(ft);
+    return true;
+}
+
+bool utcToLocal(uint64_t utc_ticks, uint64_t& local_ticks)
+{
+    FILETIME ft = toFileTime(utc_ticks);
+    SYSTEMTIME utc, local;
+    if (!FileTimeToSystemTime(&ft, &utc)) return false;
+    if (!SystemTimeToTzSpecificLocalTime(nullptr, &utc, &local)) return false;
+    if (!SystemTimeToFileTime(&local, &ft)) return false;
+    local_ticks = toTicks(ft);
+    return true;
+}
+
+int dayOfYear(uint64_t local_midnight)
+{
+    FILETIME ft = toFileTime(local_midnight);
+    SYSTEMTIME date;
+    FileTimeToSystemTime(&ft, &date);
+
+    static const int kDaysBefore[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+    bool leap = (date.wYear % 4 == 0 && date.wYear % 100 != 0) || date.wYear % 400 == 0;
+    int day = kDaysBefore[date.wMonth - 1] + date.wDay;
+    if (leap && date.wMonth > 2) ++day;
+    return day;
+}
+
+double normalizeDegrees(double degrees)
+{
+    degrees = std::fmod(degrees, 360.0);
+    return degrees < 0.0 ? degrees + 360.0 : degrees;
+}
+
+// Sunrise or sunset in UTC hours [0, 24) for a day of the year, using the
+// Almanac for Computers approximation (good to a minute or two). NaN when
+// the sun stays above or below the horizon all day.
+double sunEventUtcHours(int day_of_year, double latitude, double longitude, bool sunrise)
+{
+    constexpr double kRad = kPi / 180.0;
+    constexpr double kZenith = 90.833;  // Includes refraction and the solar disc
+
+    double lng_hour = longitude / 15.0;
+    double t = day_of_year + ((sunrise ? 6.0 : 18.0) - lng_hour) / 24.0;
+
+    double mean_anomaly = 0.9856 * t - 3.289;
+    double true_longitude = normalizeDegrees(mean_anomaly
+        + 1.916 * std::sin(mean_anomaly * kRad)
+        + 0.020 * std::sin(2.0 * mean_anomaly * kRad) + 282.634);
+
+    double right_ascension = normalizeDegrees(
+        std::atan(0.91764 * std::tan(true_longitude * kRad)) / kRad);
+    right_ascension += std::floor(true_longitude / 90.0) * 90.0
+                     - std::floor(right_ascension / 90.0) * 90.0;
+    right_ascension /= 15.0;
+
+    double sin_dec = 0.39782 * std::sin(true_longitude * kRad);
+    double cos_dec = std::cos(std::asin(sin_dec));
+    double cos_h = (std::cos(kZenith * kRad) - sin_dec * std::sin(latitude * kRad))
+                 / (cos_dec * std::cos(latitude * kRad));
+    if (cos_h > 1.0 || cos_h < -1.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double hour_angle = std::acos(cos_h) / kRad;
+    if (sunrise) hour_angle = 360.0 - hour_angle;
+    hour_angle /= 15.0;
+
+    double local_mean = hour_angle + right_ascension - 0.06571 * t - 6.622;
+    double ut = std::fmod(local_mean - lng_hour, 24.0);
+    return ut < 0.0 ? ut + 24.0 : ut;
+}
+
+// When entry fires on the local calendar day starting at local_midnight
+bool entryTimeOnDay(const ScheduleSettings& settings, const ScheduleEntry& entry,
+                    uint64_t local_midnight, uint64_t& utc_ticks)
+{
+    const int64_t offset = static_cast<int64_t>(entry.time.minutes) *
+                           static_cast<int64_t>(kTicksPerMinute);
+
+    if (entry.time.anchor == ScheduleTime::Anchor::Clock) {
+        return localToUtc(local_midnight + offset, utc_ticks);
+    }
+
+    bool sunrise = entry.time.anchor == ScheduleTime::Anchor::Sunrise;
+    double hours = sunEventUtcHours(dayOfYear(local_midnight), settings.latitude,
+                                    settings.longitude, sunrise);
+    if (std::isnan(hours)) return false;
+
+    // The formula only gives a time of day; pick the UTC day that puts it
+    // on the right side of this local day's noon
+    uint64_t noon_utc = 0;
+    if (!localToUtc(local_midnight + 12 * kTicksPerHour, noon_utc)) return false;
+    int64_t target = static_cast<int64_t>(noon_utc) +
+                     (sunrise ? -6 : 6) * static_cast<int64_t>(kTicksPerHour);
+    int64_t base = static_cast<int64_t>((noon_utc / kTicksPerDay) * kTicksPerDay) +
+                   static_cast<int64_t>(hours * static_cast<double>(kTicksPerHour));
+
+    int64_t best = base;
+    for (int64_t day = -1; day <= 1; ++day) {
+        int64_t candidate = base + day * static_cast<int64_t>(kTicksPerDay);
+        if (std::llabs(candidate - target) < std::llabs(best - target)) {
+            best = candidate;
+        }
+    }
+    utc_ticks = static_cast<uint64_t>(best + offset);
+    return true;
+}
+
+// Scan entry occurrences on the local days around now_utc
+template <typename Accept>
+bool findScheduleEvent(const ScheduleSettings& settings, uint64_t now_utc,
+                       ScheduleEvent& out, Accept accept)
+{
+    uint64_t local_now = 0;
+    if (settings.entries.empty() || !utcToLocal(now_utc, local_now)) return false;
+    uint64_t today = (local_now / kTicksPerDay) * kTicksPerDay;
+
+    bool found = false;
+    for (int64_t day = -2; day <= 2; ++day) {
+        uint64_t local_midnight = today + day * static_cast<int64_t>(kTicksPerDay);
+        for (size_t i = 0; i < settings.entries.size(); ++i) {
+            uint64_t when = 0;
+            if (!entryTimeOnDay(settings, settings.entries[i], local_midnight, when)) continue;
+            if (accept(when, found ? out.utc_ticks : 0, found)) {
+                out.entry = i;
+                out.utc_ticks = when;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+} // anonymous namespace
+
+bool nextScheduleEvent(const ScheduleSettings& settings, uint64_t now_utc, ScheduleEvent& out)
+{
+    return findScheduleEvent(settings, now_utc, out,
+        [now_utc](uint64_t when, uint64_t best, bool have) {
+            return when > now_utc && (!have || when < best);
+        });
+}
+
+bool currentScheduleEvent(const ScheduleSettings& settings, uint64_t now_utc, ScheduleEvent& out)
+{
+    return findScheduleEvent(settings, now_utc, out,
+        [now_utc](uint64_t when, uint64_t best, bool have) {
+            return when <= now_utc && (!have || when > best);
+        });
+}
+
+uint64_t currentUtcTicks()
+{
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    return toTicks(ft);
+}
+
+std::string formatScheduleTime(const ScheduleTime& time)
+{
+    char buf[32];
+    if (time.anchor == ScheduleTime::Anchor::Clock) {
+        std::snprintf(buf, sizeof(buf), "%02d:%02d", time.minutes / 60, time.minutes % 60);
+        return buf;
+    }
+
+    const char* name = (time.anchor == ScheduleTime::Anchor::Sunrise) ? "sunrise" : "sunset";
+    if (time.minutes == 0) {
+        return name;
+    }
+    std::snprintf(buf, sizeof(buf), "%s%+d", name, time.minutes);
+    return buf;
+}
+
+bool parseScheduleTime(const std::string& str, ScheduleTime& out)
+{
+    auto parse_offset = [&](size_t prefix, ScheduleTime::Anchor anchor) {
+        std::string rest = str.substr(prefix);
+        int minutes = 0;
+        if (!rest.empty()) {
+            if (rest[0] != '+' && rest[0] != '-') return false;
+            char* end = nullptr;
+            long value = std::strtol(rest.c_str(), &end, 10);
+            if (*end != '\0' || value < -720 || value > 720) return false;
+            minutes = static_cast<int>(value);
+        }
+        out.anchor = anchor;
+        out.minutes = minutes;
+        return true;
+    };
+
+    if (str.starts_with("sunrise")) return parse_offset(7, ScheduleTime::Anchor::Sunrise);
+    if (str.starts_with("sunset")) return parse_offset(6, ScheduleTime::Anchor::Sunset);
+
+    int hours = 0, minutes = 0;
+    char trailing = 0;
+    if (std::sscanf(str.c_str(), "%d:%d%c", &hours, &minutes, &trailing) != 2 ||
+        hours < 0 || hours > 23 || minutes < 0 || minutes > 59) {
+        return false;
+    }
+    out.anchor = ScheduleTime::Anchor::Clock;
+    out.minutes = hours * 60 + minutes;
+    return true;
+}
+
+std::string formatScheduleEntry(const ScheduleEntry& entry)
+{
+    char buf[128];
+    int length = std::snprintf(buf, sizeof(buf), "%s|%s|%g|%g", formatScheduleTime(entry.time).c_str(),
+                               entry.curve.c_str(), entry.strength, entry.fade_ms);
+    if (entry.white_point_k > 0.0 && length > 0 && static_cast<size_t>(length) < sizeof(buf)) {
+        std::snprintf(buf + length, sizeof(buf) - length, "|%g", entry.white_point_k);
+    }
+    return buf;
+}
+
+bool parseScheduleEntry(const std::string& str, ScheduleEntry& out)
+{
+    size_t first = str.find('|');
+    size_t second = (first == std::string::npos) ? first : str.find('|', first + 1);
+    if (second == std::string::npos) return false;
+    size_t third = str.find('|', second + 1);
+    size_t fourth = (third == std::string::npos) ? third : str.find('|', third + 1);
+
+    ScheduleEntry entry;
+    if (!parseScheduleTime(str.substr(0, first), entry.time)) return false;
+    entry.curve = str.substr(first + 1, second - first - 1);
+    if (entry.curve.empty()) return false;
+
+    try {
+        entry.strength = std::clamp(std::stod(str.substr(second + 1, third - second - 1)), 0.1, 9.0);
+        if (third != std::string::npos) {
+            entry.fade_ms = std::clamp(std::stod(str.substr(third + 1, fourth - third - 1)),
+                                       0.0, kMaxScheduleFadeMs);
+        }
+        if (fourth != std::string::npos) {
+            entry.white_point_k = std::clamp(std::stod(str.substr(fourth + 1)), 1000.0, 25000.0);
+        }
+    } catch (...) {
+        return false;
+    }
+
+    out = entry;
+    return true;
+}
+
+std::string formatLocalTime(uint64_t utc_ticks)
+{
+    uint64_t local = 0;
+    if (!utcToLocal(utc_ticks, local)) return "--:--";
+
+    FILETIME ft = toFileTime(local);
+    SYSTEMTIME st;
+    FileTimeToSystemTime(&ft, &st);
+
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%02u:%02u", st.wHour, st.wMinute);
+    return buf;
+}
+
+} // namespace lumos
@@ -0,0 +1,72 @@
+// Lumos - Time-of-day schedule
+// Copyright (C) 2026 Ian Dirk Armstrong
+// License: GPL v2
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lumos {
+
+// When a schedule entry fires each day
+struct ScheduleTime {
+    enum class Anchor {
+        Clock,    // minutes after local midnight
+        Sunrise,  // minutes relative to sunrise (may be negative)
+        Sunset,   // minutes relative to sunset (may be negative)
+    };
+
+    Anchor anchor = Anchor::Clock;
+    int minutes = 0;
+};
+
+// One curve change. The curve is stored by name, as in TransferFunction.
+struct ScheduleEntry {
+    ScheduleTime time;
+    std::string curve = "Power";
+    double strength = 1.0;
+    double fade_ms = 0.0;  // Transition duration when the entry fires
+    double white_point_k = 0.0;  // Color temperature, 0 = leave unchanged
+};
+
+struct ScheduleSettings {
+    bool enabled = false;
+    double latitude = 0.0;   // Degrees, north positive (sunrise/sunset entries)
+    double longitude = 0.0;  // Degrees, east positive
+    std::vector<ScheduleEntry> entries;
+};
+
+// An entry occurrence, as a UTC FILETIME tick count (100 ns since 1601)
+struct ScheduleEvent {
+    size_t entry = 0;
+    uint64_t utc_ticks = 0;
+};
+
+// Longest fade a schedule entry may ask for (one hour)
+constexpr double kMaxScheduleFadeMs = 60.0 * 60.0 * 1000.0;
+
+// Next occurrence strictly after now_utc. False if there are no entries or
+// none can fire (e.g. only sun entries during polar day/night).
+bool nextScheduleEvent(const ScheduleSettings& settings, uint64_t now_utc, ScheduleEvent& out);
+
+// Most recent occurrence at or before now_utc - the entry that should be
+// in effect right now
+bool currentScheduleEvent(const ScheduleSettings& settings, uint64_t now_utc, ScheduleEvent& out);
+
+// Current time as UTC FILETIME ticks
+uint64_t currentUtcTicks();
+
+// "HH:MM", "sunrise", "sunset+30", "sunrise-45"
+std::string formatScheduleTime(const ScheduleTime& time);
+bool parseScheduleTime(const std::string& str, ScheduleTime& out);
+
+// Config form: "<time>|<curve>|<strength>|<fade ms>[|<kelvin>]"
+std::string formatScheduleEntry(const ScheduleEntry& entry);
+bool parseScheduleEntry(const std::string& str, ScheduleEntry& out);
+
+// Local wall-clock "HH:MM" for a UTC tick count (UI display)
+std::string formatLocalTime(uint64_t utc_ticks);
+
+} // namespace lumos
@@ -26,6 +26,11 @@
 namespace lumos::ui {
 
 MainWindow::~MainWindow()
+{
+    releaseIconTextures();
+}
+
+void MainWindow::releaseIconTextures()
 {
     if (bolt_texture_) {
         bolt_texture_->Release();
@@ -37,6 +42,42 @@ MainWindow::~MainWindow()
     }
 }
 
+// Curve editor geometry that never changes, built once in ImPlot's native
+// float form
+constexpr int kValidZoneSamples = 65;
+
+struct PlotGeometry {
+    std::array<float, 256> xs{};  // Ramp inputs, i / 255
+    std::array<float, 2> identity{0.0f, 1.0f};
+    std::array<float, kValidZoneSamples> zone_xs{};
+    std::array<float, kValidZoneSamples> zone_min{};
+    std::array<float, kValidZoneSamples> zone_max{};
+};
+
+static const PlotGeometry& plotGeometry()
+{
+    static const PlotGeometry geometry = [] {
+        PlotGeometry g;
+        for (size_t i = 0; i < g.xs.size(); ++i) {
+            g.xs[i] = static_cast<float>(i / 255.0);
+        }
+        for (int i = 0; i < kValidZoneSamples; ++i) {
+            double x = i / static_cast<double>(kValidZoneSamples - 1);
+            g.zone_xs[i] = static_cast<float>(x);
+            g.zone_max[i] = static_cast<float>((std::min)(1.0, x * 3.0 + 0.2));
+        }
+        return g;
+    }();
+    return geometry;
+}
+
+static void toPlotValues(const platform::CurveTable& table, std::array<float, 256>& out)
+{
+    for (size_t i = 0; i < table.size(); ++i) {
+        out[i] = static_cast<float>(table[i]);
+    }
+}
+
 // Helper to create a D3D11 texture from an HICON
 static ID3D11ShaderResourceView* CreateTextureFromIcon(ID3D11Device* device, HICON hIcon, int size)
 {
@@ -367,12 +408,60 @@ void MainWindow::renderStatusBar(App& app)
     float text_y = status_y + (status_height - ImGui::GetTextLineHeight()) * 0.5f;
     draw_list->AddText(ImVec2(text_x, text_y), IM_COL32(180, 180, 180, 255), preset_name);
 
+    // Per-monitor apply latency of the last ramp push, to spot a slow driver
+    const auto& apply_times = app.getMonitorApplyTimes();
+    if (!apply_times.empty()) {
+        char timing_text[128];
+        int written = 0;
+        for (size_t i = 0; i < apply_times.size() && written < static_cast<int>(sizeof(timing_text)); ++i) {
+            written += std::snprintf(timing_text + written, sizeof(timing_text) - written,
+                                     "%s#%zu %.1f ms", i > 0 ? "  " : "", i + 1, apply_times[i]);
+        }
+        float timing_x = text_x + ImGui::CalcTextSize(preset_name).x + 16.0f;
+        draw_list->AddText(ImVec2(timing_x, text_y), IM_COL32(120, 120, 120, 255), timing_text);
+    }
+
     // Power icon on the right (clickable to toggle gamma)
     bool gamma_active = app.isGammaEnabled();
     float icon_x = window_pos.x + window_size.x - padding_x - icon_size;
 
     // Draw vertical separator before icon
     float separator_x = icon_x - 8.0f;
+
+    // Display DC creations and main loop wakeups per second (sampled once a second)
+    double now = ImGui::GetTime();
+    if (now - dc_sample_time_ >= 1.0) {
+        uint64_t dc_count = app.getDcCreationCount();
+        uint64_t wakeup_count = app.getWakeupCount();
+        if (dc_sample_time_ > 0.0) {
+            dc_per_second_ = static_cast<double>(dc_count - dc_count_sample_) / (now - dc_sample_time_);
+            wakeups_per_second_ = static_cast<double>(wakeup_count - wakeup_count_sample_) / (now - dc_sample_time_);
+        }
+        dc_count_sample_ = dc_count;
+        wakeup_count_sample_ = wakeup_count;
+        dc_sample_time_ = now;
+    }
+    char dc_text[48];
+    std::snprintf(dc_text, sizeof(dc_text), "Wake/s: %.1f  DC/s: %.0f", wakeups_per_second_, dc_per_second_);
+    float dc_text_x = separator_x - 8.0f - ImGui::CalcTextSize(dc_text).x;
+    draw_list->AddText(ImVec2(dc_text_x, text_y),
+                       show_perf_overlay_ ? IM_COL32(200, 200, 200, 255) : IM_COL32(120, 120, 120, 255),
+                       dc_text);
+
+    // The counters double as the latency overlay toggle
+    ImGui::SetCursorScreenPos(ImVec2(dc_text_x, status_y));
+    ImGui::InvisibleButton("##PerfToggle", ImVec2(ImGui::CalcTextSize(dc_text).x, status_height));
+    if (ImGui::IsItemClicked()) {
+        show_perf_overlay_ = !show_perf_overlay_;
+        app.setPerfTracing(show_perf_overlay_);
+        if (!show_perf_overlay_) {
+            perf_export_status_.clear();
+        }
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip(show_perf_overlay_ ? "Click to hide latency timings"
+                                             : "Click to show latency timings");
+    }
     draw_list->AddLine(
         ImVec2(separator_x, status_y + 4.0f),
         ImVec2(separator_x, status_y + status_height - 4.0f),
@@ -403,12 +492,127 @@ void MainWindow::renderStatusBar(App& app)
     if (ImGui::IsItemHovered()) {
         ImGui::SetTooltip(gamma_active ? "Click to disable gamma" : "Click to enable gamma");
     }
+
+    if (show_perf_overlay_) {
+        renderPerfOverlay(app, status_y);
+    }
+}
+
+void MainWindow::renderPerfOverlay(App& app, float status_y)
+{
+    using lumos::platform::PerfStage;
+
+    // Anchored to the bottom right, just above the status bar
+    ImVec2 window_pos = ImGui::GetWindowPos();
+    ImVec2 window_size = ImGui::GetWindowSize();
+    float padding_x = ImGui::GetStyle().WindowPadding.x;
+    ImGui::SetNextWindowPos(ImVec2(window_pos.x + window_size.x - padding_x, status_y - 4.0f),
+                            ImGuiCond_Always, ImVec2(1.0f, 1.0f));
+    ImGui::SetNextWindowBgAlpha(0.9f);
+
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                                   ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+                                   ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove;
+    if (ImGui::Begin("##PerfOverlay", nullptr, flags)) {
+        if (ImGui::BeginTable("##PerfStages", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("Stage");
+            ImGui::TableSetupColumn("n");
+            ImGui::TableSetupColumn("p50 ms");
+            ImGui::TableSetupColumn("p99 ms");
+            ImGui::TableSetupColumn("max ms");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < lumos::platform::kPerfStageCount; ++i) {
+                PerfStage stage = static_cast<PerfStage>(i);
+                lumos::platform::PerfStageStats stats = app.getPerfStats(stage);
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(lumos::platform::perfStageName(stage));
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", stats.count);
+                if (stats.count == 0) {
+                    for (int c = 0; c < 3; ++c) {
+                        ImGui::TableNextColumn();
+                        ImGui::TextDisabled("-");
+                    }
+                    continue;
+                }
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats.p50_ms);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats.p99_ms);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats.max_ms);
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::SmallButton("Export Trace")) {
+            std::string path;
+            perf_export_status_ = app.exportPerfTrace(path) ? "Saved " + path
+                                                            : "Could not write " + path;
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Clear")) {
+            app.clearPerfTrace();
+            perf_export_status_.clear();
+        }
+        if (!perf_export_status_.empty()) {
+            ImGui::TextDisabled("%s", perf_export_status_.c_str());
+        }
+    }
+    ImGui::End();
 }
 
 void MainWindow::renderGammaTab(App& app)
 {
     ImGui::Spacing();
 
+    // Which display the curve controls below edit (mixed panels can each
+    // have their own curve)
+    int monitor_count = static_cast<int>(app.getMonitorCount());
+    if (monitor_count > 1) {
+        int edit_monitor = app.getEditMonitor();
+        auto display_label = [&app](int index, char* out, size_t size) {
+            if (index < 0) {
+                std::snprintf(out, size, "All displays");
+            } else {
+                std::snprintf(out, size, "Display %d%s", index + 1,
+                              app.hasDisplayProfile(static_cast<size_t>(index)) ? " (own curve)" : "");
+            }
+        };
+
+        ImGui::TextUnformatted("Display");
+        char preview[48];
+        display_label(edit_monitor, preview, sizeof(preview));
+        ImGui::SetNextItemWidth(-1);
+        if (ImGui::BeginCombo("##EditMonitor", preview)) {
+            for (int i = -1; i < monitor_count; ++i) {
+                char label[48];
+                display_label(i, label, sizeof(label));
+                if (ImGui::Selectable(label, edit_monitor == i)) {
+                    app.setEditMonitor(i);
+                    ui_curve_points_ = app.getCustomCurvePoints();
+                }
+            }
+            ImGui::EndCombo();
+        }
+
+        if (edit_monitor >= 0) {
+            bool own_curve = app.hasDisplayProfile(static_cast<size_t>(edit_monitor));
+            if (ImGui::Checkbox("Separate curve for this display", &own_curve)) {
+                app.setDisplayProfileEnabled(static_cast<size_t>(edit_monitor), own_curve);
+                ui_curve_points_ = app.getCustomCurvePoints();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Off: this display follows the All displays curve, and "
+                                  "the controls below edit that curve");
+            }
+        }
+        ImGui::Spacing();
+    }
+
     // Tone curve preset selector
     ImGui::TextUnformatted("Tone Curve Preset");
     const char* tone_curves[] = {
@@ -444,6 +648,24 @@ void MainWindow::renderGammaTab(App& app)
 
     ImGui::Spacing();
 
+    // Color temperature, applied per channel in the same ramp as the curve
+    ImGui::TextUnformatted("Color Temperature");
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Warms (or cools) the white point. 6500 K leaves colors unchanged.");
+    }
+    int white_point = static_cast<int>(app.getWhitePoint());
+    ImGui::SetNextItemWidth(-1);
+    if (ImGui::SliderInt("##WhitePoint", &white_point,
+                         static_cast<int>(platform::kMinWhitePointK),
+                         static_cast<int>(platform::kMaxWhitePointK), "%d K")) {
+        app.setWhitePoint(white_point);
+    }
+    if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+        app.setWhitePoint(platform::kNeutralWhitePointK, true);
+    }
+
+    ImGui::Spacing();
+
     // Determine which mode we're in
     bool is_power_mode = (transfer_function_index_ == 1);  // Simple Gamma
     bool is_custom_mode = (transfer_function_index_ == 5); // Custom
@@ -550,6 +772,15 @@ void MainWindow::renderGammaTab(App& app)
             app.setCustomCurvePoints(ui_curve_points_);
             // Keep the original reference curve untouched so it remains a baseline
         }
+
+        bool smooth = app.getCustomCurveInterpolation() == platform::CurveInterpolation::MonotoneCubic;
+        if (ImGui::Checkbox("Smooth interpolation", &smooth)) {
+            app.setCustomCurveInterpolation(smooth ? platform::CurveInterpolation::MonotoneCubic
+                                                   : platform::CurveInterpolation::Linear);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Monotone cubic spline through the points (no overshoot)");
+        }
         ImGui::Spacing();
     }
 
@@ -583,112 +814,77 @@ void MainWindow::renderGammaTab(App& app)
         plot_y_max_ = 1.05;
     }
 
-    // Sort curve points before any operations
-    if (is_custom_mode && !ui_curve_points_.empty()) {
+    // Sort curve points before any operations (already sorted unless just edited)
+    if (is_custom_mode && !std::is_sorted(ui_curve_points_.begin(), ui_curve_points_.end())) {
         std::sort(ui_curve_points_.begin(), ui_curve_points_.end());
     }
-    if (is_custom_mode && !reference_curve_points_.empty()) {
+    if (is_custom_mode &&
+        !std::is_sorted(reference_curve_points_.begin(), reference_curve_points_.end())) {
         std::sort(reference_curve_points_.begin(), reference_curve_points_.end());
     }
 
-    // Prepare curve data for ImPlot (256 samples)
-    static std::vector<double> curve_xs(256);
-    static std::vector<double> curve_ys(256);
-    static std::vector<double> linear_xs(2);
-    static std::vector<double> linear_ys(2);
-    static std::vector<double> ref_curve_xs(256);
-    static std::vector<double> ref_curve_ys(256);
-
-    // Linear reference line
-    linear_xs[0] = 0.0; linear_ys[0] = 0.0;
-    linear_xs[1] = 1.0; linear_ys[1] = 1.0;
-
+    const PlotGeometry& geometry = plotGeometry();
     const double gamma = static_cast<double>(gamma_slider_);
 
-    // Helper to evaluate the active tone curve at [0,1]
-    auto eval_curve = [&](double linear) -> double {
-        if (is_custom_mode && !ui_curve_points_.empty()) {
-            const auto& points = ui_curve_points_;
-            if (linear <= points.front().x) return points.front().y;
-            if (linear >= points.back().x) return points.back().y;
-            for (size_t j = 0; j < points.size() - 1; ++j) {
-                if (linear >= points[j].x && linear <= points[j + 1].x) {
-                    double x1 = points[j].x, y1 = points[j].y;
-                    double x2 = points[j + 1].x, y2 = points[j + 1].y;
-                    double t = (linear - x1) / (x2 - x1);
-                    return y1 + t * (y2 - y1);
-                }
-            }
-            return linear;
-        }
-
-        switch (transfer_function_index_) {
-            case 0: // Neutral
-                return linear;
-            case 2: // Shadow Lift
-                return (linear <= 0.0031308)
-                    ? 12.92 * linear
-                    : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
-            case 3: // Soft Contrast
-                return (linear < 0.018)
-                    ? 4.5 * linear
-                    : 1.099 * std::pow(linear, 0.45) - 0.099;
-            case 4: // Cinema
-                return std::pow(linear, 1.0 / 2.6);
-            case 1: // Simple Gamma
-            default:
-                return std::pow(linear, 1.0 / gamma);
-        }
+    // Active curve, evaluated by the same code that builds the ramp
+    static constexpr platform::ToneCurve kIndexCurves[] = {
+        platform::ToneCurve::Linear, platform::ToneCurve::Power,
+        platform::ToneCurve::ShadowLift, platform::ToneCurve::SoftContrast,
+        platform::ToneCurve::Cinema, platform::ToneCurve::Custom,
     };
-
-    // Generate curve data
-    for (int i = 0; i < 256; ++i) {
-        double x = i / 255.0;
-        curve_xs[i] = x;
-        curve_ys[i] = eval_curve(x);
+    const platform::ToneCurve preview_curve = kIndexCurves[transfer_function_index_];
+    const std::vector<platform::CurvePoint>* preview_points =
+        (is_custom_mode && ui_curve_points_.size() >= 2) ? &ui_curve_points_ : nullptr;
+
+    const platform::CurveInterpolation interpolation = app.getCustomCurveInterpolation();
+
+    // Keyed like the ramp cache, so a drag re-evaluates once per change and
+    // an untouched curve costs nothing per frame
+    platform::RampKey preview_key = platform::Gamma::makeRampKey(preview_curve, gamma, preview_points,
+                                                                 interpolation);
+    if (!preview_valid_ || !(preview_key == preview_key_)) {
+        platform::evaluateCurve(preview_curve, gamma, preview_points, interpolation, preview_curve_);
+        toPlotValues(preview_curve_, preview_plot_ys_);
+        preview_key_ = preview_key;
+        preview_valid_ = true;
     }
 
-    // Generate reference curve data for custom mode
+    // Reference curve for custom mode
     if (is_custom_mode && !reference_curve_points_.empty()) {
-        auto eval_reference = [&](double linear) -> double {
-            const auto& pts = reference_curve_points_;
-            if (linear <= pts.front().x) return pts.front().y;
-            if (linear >= pts.back().x) return pts.back().y;
-            for (size_t j = 0; j < pts.size() - 1; ++j) {
-                if (linear >= pts[j].x && linear <= pts[j + 1].x) {
-                    double t = (linear - pts[j].x) / (pts[j + 1].x - pts[j].x);
-                    return pts[j].y + t * (pts[j + 1].y - pts[j].y);
-                }
-            }
-            return linear;
-        };
-        for (int i = 0; i < 256; ++i) {
-            double x = i / 255.0;
-            ref_curve_xs[i] = x;
-            ref_curve_ys[i] = eval_reference(x);
+        platform::RampKey reference_key = platform::Gamma::makeRampKey(
+            platform::ToneCurve::Custom, 1.0, &reference_curve_points_, interpolation);
+        if (!(reference_key == reference_key_)) {
+            reference_compiled_ = platform::CompiledCurve(reference_curve_points_, interpolation);
+            platform::CurveTable reference_curve;
+            reference_compiled_.sample(reference_curve);
+            toPlotValues(reference_curve, reference_plot_ys_);
+            reference_key_ = reference_key;
         }
     }
 
-    // Prepare histogram data if enabled
-    static std::vector<double> hist_xs(256);
-    static std::vector<double> hist_ys_pre(256);
-    static std::vector<double> hist_ys_post(256);
-
     if (show_histogram_) {
-        auto histogram = app.getScreenHistogram();
-        if (histogram.valid) {
+        // Rebuild only when a new sample arrived or the curve changed
+        const auto& histogram = app.getScreenHistogram(histogram_monitor_);
+        bool curve_changed = !(preview_key_ == histogram_curve_key_);
+        bool stale = histogram.generation != histogram_generation_ ||
+                     histogram_monitor_ != histogram_source_ || curve_changed;
+        histogram_valid_ = histogram.valid;
+
+        if (histogram.valid && stale) {
+            histogram_generation_ = histogram.generation;
+            histogram_source_ = histogram_monitor_;
+            histogram_curve_key_ = preview_key_;
+
             // Reset arrays
             for (int i = 0; i < 256; ++i) {
-                hist_xs[i] = i / 255.0;
                 histogram_ys_[i] = histogram.luminance[i];
                 histogram_ys_post_[i] = 0.0f;
             }
 
             // Build "post" histogram by remapping bin centers through the active curve
             for (int i = 0; i < 256; ++i) {
-                double in_x = i / 255.0;
                 float weight = histogram_ys_[i];
-                double out_x = std::clamp(eval_curve(in_x), 0.0, 1.0);
+                double out_x = std::clamp(preview_curve_[i], 0.0, 1.0);  // curve at i / 255
 
                 double pos = out_x * 255.0;
                 int idx = static_cast<int>(pos);
@@ -702,22 +898,18 @@ void MainWindow::renderGammaTab(App& app)
                 }
             }
 
-            // Normalize both histograms independently to preserve shape
+            // Normalize both histograms independently to preserve shape,
+            // scaled to 70% of the plot height
             auto normalize = [](std::array<float, 256>& arr) {
                 float m = 0.0f;
                 for (float v : arr) m = (std::max)(m, v);
                 if (m > 0.0f) {
-                    for (float& v : arr) v /= m;
+                    const float scale = 0.7f / m;
+                    for (float& v : arr) v *= scale;
                 }
             };
             normalize(histogram_ys_);
             normalize(histogram_ys_post_);
-
-            // Copy to double arrays for ImPlot
-            for (int i = 0; i < 256; ++i) {
-                hist_ys_pre[i] = histogram_ys_[i] * 0.7;  // Scale to 70% height
-                hist_ys_post[i] = histogram_ys_post_[i] * 0.7;
-            }
         }
     }
 
@@ -726,19 +918,6 @@ void MainWindow::renderGammaTab(App& app)
         ui_curve_points_ = app.getCustomCurvePoints();
     }
 
-    // Prepare valid zone data for custom mode
-    static std::vector<double> valid_zone_xs(65);
-    static std::vector<double> valid_zone_min(65);
-    static std::vector<double> valid_zone_max(65);
-    if (is_custom_mode) {
-        for (int i = 0; i <= 64; ++i) {
-            double x_norm = i / 64.0;
-            valid_zone_xs[i] = x_norm;
-            valid_zone_min[i] = 0.0;
-            valid_zone_max[i] = (std::min)(1.0, x_norm * 3.0 + 0.2);
-        }
-    }
-
     // ImPlot curve editor with zoom/pan
     ImPlotFlags plot_flags = ImPlotFlags_NoTitle | ImPlotFlags_NoLegend;
     ImPlotAxisFlags axis_flags = ImPlotAxisFlags_None;
@@ -758,35 +937,33 @@ void MainWindow::renderGammaTab(App& app)
         ImPlot::SetupAxisZoomConstraints(ImAxis_Y1, 0.01, 2.0);
 
         // Draw histogram as bars (if enabled and valid)
-        if (show_histogram_) {
-            auto histogram = app.getScreenHistogram();
-            if (histogram.valid) {
-                ImPlot::SetNextFillStyle(ImVec4(0.24f, 0.35f, 0.59f, 0.4f));
-                ImPlot::PlotBars("Pre", hist_xs.data(), hist_ys_pre.data(), 256, 0.003);
-                ImPlot::SetNextFillStyle(ImVec4(0.78f, 0.55f, 0.24f, 0.4f));
-                ImPlot::PlotBars("Post", hist_xs.data(), hist_ys_post.data(), 256, 0.003);
-            }
+        if (show_histogram_ && histogram_valid_) {
+            ImPlot::SetNextFillStyle(ImVec4(0.24f, 0.35f, 0.59f, 0.4f));
+            ImPlot::PlotBars("Pre", geometry.xs.data(), histogram_ys_.data(), 256, 0.003);
+            ImPlot::SetNextFillStyle(ImVec4(0.78f, 0.55f, 0.24f, 0.4f));
+            ImPlot::PlotBars("Post", geometry.xs.data(), histogram_ys_post_.data(), 256, 0.003);
         }
 
         // Draw valid zone (shaded area) for custom mode
         if (is_custom_mode) {
             ImPlot::SetNextFillStyle(ImVec4(0.2f, 0.4f, 0.2f, 0.3f));
-            ImPlot::PlotShaded("ValidZone", valid_zone_xs.data(), valid_zone_min.data(), valid_zone_max.data(), 65);
+            ImPlot::PlotShaded("ValidZone", geometry.zone_xs.data(), geometry.zone_min.data(),
+                               geometry.zone_max.data(), kValidZoneSamples);
         }
 
         // Draw linear reference line (identity)
         ImPlot::SetNextLineStyle(ImVec4(0.4f, 0.4f, 0.4f, 1.0f), 1.5f);
-        ImPlot::PlotLine("Identity", linear_xs.data(), linear_ys.data(), 2);
+        ImPlot::PlotLine("Identity", geometry.identity.data(), geometry.identity.data(), 2);
 
         // Draw reference curve (dashed) for custom mode
         if (is_custom_mode && !reference_curve_points_.empty()) {
             ImPlot::SetNextLineStyle(ImVec4(0.7f, 0.7f, 0.7f, 0.6f), 1.0f);
-            ImPlot::PlotLine("Reference", ref_curve_xs.data(), ref_curve_ys.data(), 256);
+            ImPlot::PlotLine("Reference", geometry.xs.data(), reference_plot_ys_.data(), 256);
         }
 
         // Draw main tone curve
         ImPlot::SetNextLineStyle(ImVec4(0.4f, 0.8f, 0.4f, 1.0f), 2.5f);
-        ImPlot::PlotLine("Curve", curve_xs.data(), curve_ys.data(), 256);
+        ImPlot::PlotLine("Curve", geometry.xs.data(), preview_plot_ys_.data(), 256);
 
         // Interactive control points using ImPlot::DragPoint (only in Custom mode)
         if (is_custom_mode && !ui_curve_points_.empty()) {
@@ -834,19 +1011,9 @@ void MainWindow::renderGammaTab(App& app)
                     // Snap to reference curve if close
                     if (!reference_curve_points_.empty()) {
                         // Interpolate reference Y at this X
-                        double ref_y = py;
-                        const auto& pts = reference_curve_points_;
-                        if (px <= pts.front().x) ref_y = pts.front().y;
-                        else if (px >= pts.back().x) ref_y = pts.back().y;
-                        else {
-                            for (size_t j = 0; j < pts.size() - 1; ++j) {
-                                if (px >= pts[j].x && px <= pts[j + 1].x) {
-                                    double t = (px - pts[j].x) / (pts[j + 1].x - pts[j].x);
-                                    ref_y = pts[j].y + t * (pts[j + 1].y - pts[j].y);
-                                    break;
-                                }
-                            }
-                        }
+                        double ref_y = reference_compiled_.valid()
+                            ? reference_compiled_.evaluate(px)
+                            : reference_curve_points_.front().y;
                         const double snap_threshold = 0.02;
                         if (std::fabs(py - ref_y) < snap_threshold) {
                             py = ref_y;
@@ -1191,6 +1358,44 @@ void MainWindow::renderSettingsTab(App& app)
         ImGui::SetTooltip("Shows screen luminance distribution in the curve preview");
     }
 
+    // Histogram source (each display is sampled separately)
+    int monitor_count = static_cast<int>(app.getMonitorCount());
+    if (histogram_monitor_ >= monitor_count) {
+        histogram_monitor_ = -1;
+    }
+    if (monitor_count > 1) {
+        char preview[32];
+        if (histogram_monitor_ < 0) {
+            std::snprintf(preview, sizeof(preview), "All displays");
+        } else {
+            std::snprintf(preview, sizeof(preview), "Display %d", histogram_monitor_ + 1);
+        }
+        ImGui::SetNextItemWidth(160.0f);
+        if (ImGui::BeginCombo("Histogram source", preview)) {
+            if (ImGui::Selectable("All displays", histogram_monitor_ < 0)) {
+                histogram_monitor_ = -1;
+            }
+            for (int i = 0; i < monitor_count; ++i) {
+                char label[32];
+                std::snprintf(label, sizeof(label), "Display %d", i + 1);
+                if (ImGui::Selectable(label, histogram_monitor_ == i)) {
+                    histogram_monitor_ = i;
+                }
+            }
+            ImGui::EndCombo();
+        }
+    }
+
+    bool gpu_histogram = app.isGpuHistogramEnabled();
+    if (ImGui::Checkbox("GPU histogram (full resolution)", &gpu_histogram)) {
+        app.setGpuHistogramEnabled(gpu_histogram);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip(app.isGpuHistogramActive()
+            ? "Builds the histogram with a compute shader from every pixel"
+            : "Not available on this system - using downsampled CPU histogram");
+    }
+
     ImGui::Spacing();
     ImGui::Spacing();
     ImGui::Separator();
@@ -1221,6 +1426,133 @@ void MainWindow::renderSettingsTab(App& app)
     ImGui::Separator();
     ImGui::Spacing();
 
+    ImGui::TextUnformatted("Auto Gamma");
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    AutoGammaSettings auto_gamma = app.getAutoGamma();
+    bool auto_changed = ImGui::Checkbox("Adapt strength to screen content", &auto_gamma.enabled);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Lifts dark content and relaxes bright content (Power curve only).\n"
+                          "Keeps sampling the screen while in the tray.");
+    }
+    if (auto_gamma.enabled) {
+        float target = static_cast<float>(auto_gamma.target);
+        float amount = static_cast<float>(auto_gamma.amount);
+        float max_boost = static_cast<float>(auto_gamma.max_boost);
+        ImGui::SetNextItemWidth(160.0f);
+        if (ImGui::SliderFloat("Midtone target", &target, 0.2f, 0.7f, "%.2f")) {
+            auto_gamma.target = target;
+            auto_changed = true;
+        }
+        ImGui::SetNextItemWidth(160.0f);
+        if (ImGui::SliderFloat("Amount", &amount, 0.0f, 1.0f, "%.2f")) {
+            auto_gamma.amount = amount;
+            auto_changed = true;
+        }
+        ImGui::SetNextItemWidth(160.0f);
+        if (ImGui::SliderFloat("Max adjustment", &max_boost, 1.0f, 3.0f, "x%.2f")) {
+            auto_gamma.max_boost = max_boost;
+            auto_changed = true;
+        }
+        ImGui::TextDisabled("Median %.2f, factor x%.2f", app.getAutoGammaMedian(),
+                            app.getAutoGammaFactor());
+    }
+    if (auto_changed) {
+        app.setAutoGamma(auto_gamma);
+    }
+
+    ImGui::Spacing();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    ImGui::TextUnformatted("Schedule");
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    const ScheduleSettings& schedule = app.getSchedule();
+    bool schedule_enabled = schedule.enabled;
+    if (ImGui::Checkbox("Change curve on a schedule", &schedule_enabled)) {
+        app.setScheduleEnabled(schedule_enabled);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Entries are edited in the [Schedule] section of lumos.ini");
+    }
+
+    double latitude = schedule.latitude;
+    double longitude = schedule.longitude;
+    ImGui::SetNextItemWidth(160.0f);
+    bool location_changed = ImGui::InputDouble("Latitude", &latitude, 0.0, 0.0, "%.3f");
+    ImGui::SetNextItemWidth(160.0f);
+    location_changed |= ImGui::InputDouble("Longitude", &longitude, 0.0, 0.0, "%.3f");
+    if (location_changed) {
+        app.setScheduleLocation(latitude, longitude);
+    }
+
+    if (schedule.entries.empty()) {
+        ImGui::TextDisabled("No entries");
+    }
+    for (const auto& entry : schedule.entries) {
+        ImGui::BulletText("%s  %s %.2f  (fade %.0f s)", formatScheduleTime(entry.time).c_str(),
+                          entry.curve.c_str(), entry.strength, entry.fade_ms / 1000.0);
+    }
+
+    ScheduleEvent next_event;
+    if (app.getNextScheduleEvent(next_event)) {
+        const ScheduleEntry& next = schedule.entries[next_event.entry];
+        ImGui::Text("Next: %s at %s", next.curve.c_str(),
+                    formatLocalTime(next_event.utc_ticks).c_str());
+    }
+
+    ImGui::Spacing();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    ImGui::TextUnformatted("Transitions");
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    int transition_ms = static_cast<int>(app.getTransitionMs());
+    ImGui::SetNextItemWidth(160.0f);
+    if (ImGui::SliderInt("Fade duration", &transition_ms, 0, 2000, "%d ms")) {
+        app.setTransitionMs(transition_ms);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Fade toggle, reset and hotkey changes over this long (0 = instant)");
+    }
+
+    ImGui::Spacing();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    ImGui::TextUnformatted("Ramp Verification");
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // Order matches platform::VerifyPolicy
+    const char* verify_policies[] = { "Full", "Sampled", "Trust driver" };
+    int verify_index = static_cast<int>(app.getVerifyPolicy());
+    ImGui::SetNextItemWidth(160.0f);
+    if (ImGui::Combo("Readback check", &verify_index, verify_policies, IM_ARRAYSIZE(verify_policies))) {
+        app.setVerifyPolicy(static_cast<platform::VerifyPolicy>(verify_index));
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip(
+            "Windows can silently ignore a gamma ramp, so Lumos reads it back.\n"
+            "Full: compare every entry after every change (slowest, most careful)\n"
+            "Sampled: full check the first time a display accepts a curve, then a\n"
+            "  16-point check; ramps a display already accepted are not read back\n"
+            "Trust driver: after that first full check, skip readback entirely");
+    }
+
+    ImGui::Spacing();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
     ImGui::TextUnformatted("Reset");
     ImGui::Separator();
     ImGui::Spacing();
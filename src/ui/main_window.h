@@ -5,9 +5,11 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include "../platform/win32/gamma.h"
+#include "../platform/win32/tone_curve.h"
 #include "../config.h"
 
 struct ID3D11Device;
@@ -27,6 +29,9 @@ public:
     // Initialize icon textures (call after ImGui D3D11 init)
     void initIconTextures(ID3D11Device* device);
 
+    // Release icon textures (call before the D3D11 device goes away)
+    void releaseIconTextures();
+
     // Render the window (call each frame)
     void render(App& app);
 
@@ -41,6 +46,7 @@ public:
 private:
     void renderMenuBar(App& app);
     void renderStatusBar(App& app);
+    void renderPerfOverlay(App& app, float status_y);
     void renderGammaTab(App& app);
     void renderHelpTab();
     void renderAboutTab();
@@ -66,10 +72,24 @@ private:
 
     // Histogram display
     bool show_histogram_ = true;
-    std::array<float, 256> histogram_xs_{};   // X values (0-1)
-    std::array<float, 256> histogram_ys_{};   // Y values (normalized)
+    int histogram_monitor_ = -1;              // Histogram source display (-1 = all)
+    std::array<float, 256> histogram_ys_{};      // Bar heights as plotted
     std::array<float, 256> histogram_ys_post_{}; // After tone curve
-    std::array<float, 256> histogram_diff_{};    // Post - pre
+    uint64_t histogram_generation_ = 0;          // Sample the arrays were built from
+    int histogram_source_ = -1;                  // histogram_monitor_ they were built for
+    platform::RampKey histogram_curve_key_{};    // Curve the post histogram was remapped with
+    bool histogram_valid_ = false;
+
+    // Preview curve samples, re-evaluated only when the curve changes
+    platform::CurveTable preview_curve_{};
+    std::array<float, 256> preview_plot_ys_{};  // Same samples, as ImPlot draws them
+    platform::RampKey preview_key_{};
+    bool preview_valid_ = false;
+
+    // Reference curve, compiled once per change for the overlay and snapping
+    platform::CompiledCurve reference_compiled_;
+    std::array<float, 256> reference_plot_ys_{};
+    platform::RampKey reference_key_{};
 
     // Tab visibility
     bool show_help_tab_ = false;
@@ -96,6 +116,17 @@ private:
     ID3D11ShaderResourceView* bolt_texture_ = nullptr;
     ID3D11ShaderResourceView* bolt_slash_texture_ = nullptr;
 
+    // Display DC creation rate shown in the status bar (should stay at 0)
+    uint64_t dc_count_sample_ = 0;
+    double dc_sample_time_ = 0.0;
+    double dc_per_second_ = 0.0;
+    uint64_t wakeup_count_sample_ = 0;
+    double wakeups_per_second_ = 0.0;
+
+    // Latency overlay above the status bar (turns the hot-path timers on)
+    bool show_perf_overlay_ = false;
+    std::string perf_export_status_;
+
     // File dialog state
     std::string last_curve_directory_;
 };